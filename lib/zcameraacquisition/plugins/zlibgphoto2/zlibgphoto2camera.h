@@ -34,6 +34,9 @@ public:
     explicit ZLibGPhoto2Camera(GPContext *context, Camera *camera, QObject *parent = nullptr);
     ~ZLibGPhoto2Camera() override;
 
+    /// getSnapshot returns one of the buffer images
+    bool snapshotIsCopy() override { return false; }
+
 signals:
 
 public slots:
@@ -43,6 +46,9 @@ public slots:
 
     ZCameraImagePtr getSnapshot() override;
 
+    /// snapshots are not taken from the preview frames, burst is not supported
+    bool armBurst(int frameCount) override { Q_UNUSED(frameCount) return false; }
+
     /// camera attributes (settings)
     QList<ZCameraAttribute> getAllAttributes() override;
     QVariant getAttribute(const QString &id) const override;
@@ -34,6 +34,10 @@ ZSimulatedCamera::ZSimulatedCamera(QVariantMap options, QObject *parent)
     , m_imageCache(200000000) /// 200mb max
 {
     m_uuid = QString("ZSIMULATED-%1").arg(options["Name"].toString());
+
+    /// images are replaced as soon as "CurrentFile" is set, before the
+    /// snapshot is requested, so there's no need to wait for a new frame
+    m_snapshotFrameDelay = 0;
     m_folder = options["Folder"].toString();
 
     m_dir = QDir::current();
@@ -28,6 +28,8 @@
 #include <QStringList>
 #include <QVariant>
 
+#include <vector>
+
 namespace Z3D
 {
 
@@ -90,6 +92,11 @@ public:
 
     virtual int bufferSize() = 0;
 
+    /// true if getSnapshot always returns a new image (i.e. not one of the
+    /// camera buffers that will be overwritten later), so it can be kept
+    /// without making a copy
+    virtual bool snapshotIsCopy() = 0;
+
 signals:
     void newImageReceived(Z3D::ZCameraImagePtr image);
 
@@ -108,6 +115,15 @@ public slots:
     virtual bool requestSnapshot() = 0;
     virtual ZCameraImagePtr getSnapshot() = 0;
 
+    /// burst acquisition, to acquire a complete sequence with little overhead.
+    /// Once armed, each requestSnapshot tags the next fresh frame with its
+    /// index in the sequence and the frame is stored in a preallocated buffer.
+    /// waitForBurstFrame blocks until the frame with that index is stored and
+    /// getBurst returns the whole sequence and disarms the camera
+    virtual bool armBurst(int frameCount) = 0;
+    virtual bool waitForBurstFrame(int index) = 0;
+    virtual std::vector<ZCameraImagePtr> getBurst() = 0;
+
     /// acquisition control
     Q_INVOKABLE virtual bool startAcquisition() = 0;
     Q_INVOKABLE virtual bool stopAcquisition() = 0;
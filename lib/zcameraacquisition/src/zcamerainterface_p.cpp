@@ -26,8 +26,10 @@
 #include <QCoreApplication>
 #include <QDebug>
 #include <QDir>
+#include <QEventLoop>
 #include <QSettings>
 #include <QStringList>
+#include <QTimer>
 
 namespace Z3D
 {
@@ -35,7 +37,12 @@ namespace Z3D
 ZCameraBase::ZCameraBase(QObject *parent)
     : ZCameraInterface(parent)
     , m_lastRetrievedImage(nullptr)
+    , m_snapshotFrameDelay(2)
     , m_currentImageBufferIndex(-1)
+    , m_receivedFrameCount(0)
+    , m_requestedFrameCount(-1)
+    , m_burstArmed(false)
+    , m_burstNextIndex(0)
     , m_simultaneousCapturesCount(0)
     , m_settingsWidget(nullptr)
 {
@@ -44,6 +51,11 @@ ZCameraBase::ZCameraBase(QObject *parent)
     QObject::connect(this, &ZCameraBase::acquisitionStopped,
                      this, &ZCameraBase::runningChanged);
 
+    /// count (and store if needed) every frame, no matter which thread it comes from
+    QObject::connect(this, &ZCameraBase::newImageReceived,
+                     this, &ZCameraBase::onNewImageReceived,
+                     Qt::DirectConnection);
+
     /// 50 images in buffer
     m_imagesBuffer.resize(50);
 
@@ -57,13 +69,43 @@ int ZCameraBase::bufferSize()
 
 bool ZCameraBase::requestSnapshot()
 {
-    /// TODO implement this
+    /// the snapshot will be the first image exposed after this request
+    const int requestedFrameCount = m_receivedFrameCount.load() + m_snapshotFrameDelay;
+
+    {
+        QMutexLocker locker(&m_burstMutex);
+        if (m_burstArmed) {
+            if (m_burstNextIndex >= int(m_burstImages.size())) {
+                CAMERA_WARNING("Burst is already complete, ignoring snapshot request")
+                return false;
+            }
+
+            const int index = m_burstNextIndex++;
+            if (requestedFrameCount <= m_receivedFrameCount.load()) {
+                /// the last image is already good
+                storeBurstImage(index, *m_lastRetrievedImage);
+            } else {
+                m_burstRequests.push_back({ index, requestedFrameCount });
+            }
+
+            return true;
+        }
+    }
+
+    m_requestedFrameCount.store(requestedFrameCount);
     return true;
 }
 
 ZCameraImagePtr ZCameraBase::getSnapshot()
 {
     if (isRunning()) {
+        /// wait until the requested frame arrives
+        const int requestedFrameCount = m_requestedFrameCount.fetchAndStoreOrdered(-1);
+        const auto isReceived = [&](){ return m_receivedFrameCount.load() >= requestedFrameCount; };
+        if (!waitForNewImages(isReceived)) {
+            CAMERA_WARNING("Timeout waiting for a new frame, using last image received")
+        }
+
         /// make a copy because after acquisition is stopped, buffer data _could_ be deleted
         ZCameraImagePtr last = (*m_lastRetrievedImage);
         ZCameraImagePtr snapshot(new ZImageGrayscale(last->width(), last->height(), last->xOffset(), last->yOffset(), last->bytesPerPixel()));
@@ -93,6 +135,69 @@ ZCameraImagePtr ZCameraBase::getSnapshot()
     }
 }
 
+bool ZCameraBase::armBurst(int frameCount)
+{
+    if (!isRunning() || frameCount < 1) {
+        return false;
+    }
+
+    QMutexLocker locker(&m_burstMutex);
+
+    /// preallocate with the current image format, if it's different when the
+    /// frames arrive they will be reallocated
+    m_burstImages.clear();
+    m_burstImages.resize(size_t(frameCount));
+    const ZCameraImagePtr last = *m_lastRetrievedImage;
+    if (last) {
+        for (auto &image : m_burstImages) {
+            image = ZCameraImagePtr(new ZImageGrayscale(last->width(), last->height(), last->xOffset(), last->yOffset(), last->bytesPerPixel()));
+        }
+    }
+
+    m_burstStored.assign(size_t(frameCount), false);
+    m_burstRequests.clear();
+    m_burstNextIndex = 0;
+    m_burstArmed = true;
+
+    return true;
+}
+
+bool ZCameraBase::waitForBurstFrame(int index)
+{
+    const auto isStored = [&](){
+        QMutexLocker locker(&m_burstMutex);
+        return index >= 0 && size_t(index) < m_burstStored.size() && m_burstStored[size_t(index)];
+    };
+
+    if (!waitForNewImages(isStored)) {
+        CAMERA_WARNING(QString("Timeout waiting for burst frame %1").arg(index))
+        return false;
+    }
+
+    return true;
+}
+
+std::vector<ZCameraImagePtr> ZCameraBase::getBurst()
+{
+    QMutexLocker locker(&m_burstMutex);
+
+    std::vector<ZCameraImagePtr> images;
+    images.swap(m_burstImages);
+
+    /// frames never received are returned as null images
+    for (size_t i=0; i<images.size(); ++i) {
+        if (!m_burstStored[i]) {
+            images[i].reset();
+        }
+    }
+
+    m_burstStored.clear();
+    m_burstRequests.clear();
+    m_burstArmed = false;
+
+    return images;
+}
+
 bool ZCameraBase::startAcquisition()
 {
     /// increment counter
@@ -234,6 +339,75 @@ bool ZCameraBase::setBufferSize(int bufferSize)
     return true;
 }
 
+bool ZCameraBase::waitForNewImages(const std::function<bool()> &isDone, int timeoutMs)
+{
+    if (isDone()) {
+        return true;
+    }
+
+    /// the loop lives in the calling thread, so this also works when the
+    /// frames are emitted from this same thread
+    QEventLoop eventLoop;
+
+    QObject::connect(this, &ZCameraBase::newImageReceived,
+                     &eventLoop, [&](){
+        if (isDone()) {
+            eventLoop.quit();
+        }
+    });
+
+    QTimer timeout;
+    timeout.setSingleShot(true);
+    QObject::connect(&timeout, &QTimer::timeout,
+                     &eventLoop, &QEventLoop::quit);
+    timeout.start(timeoutMs);
+
+    /// the image might have arrived while connecting
+    if (!isDone()) {
+        eventLoop.exec();
+    }
+
+    return isDone();
+}
+
+void ZCameraBase::onNewImageReceived(const ZCameraImagePtr &image)
+{
+    const int frameCount = m_receivedFrameCount.fetchAndAddOrdered(1) + 1;
+
+    QMutexLocker locker(&m_burstMutex);
+    if (!m_burstArmed || m_burstRequests.empty() || frameCount < m_burstRequests.front().frameCount) {
+        return;
+    }
+
+    /// each frame completes at most one request
+    const int index = m_burstRequests.front().index;
+    m_burstRequests.pop_front();
+
+    storeBurstImage(index, image);
+}
+
+void ZCameraBase::storeBurstImage(int index, const ZCameraImagePtr &image)
+{
+    if (!image) {
+        return;
+    }
+
+    ZCameraImagePtr &stored = m_burstImages[size_t(index)];
+    if (!stored ||
+            stored->width() != image->width() ||
+            stored->height() != image->height() ||
+            stored->xOffset() != image->xOffset() ||
+            stored->yOffset() != image->yOffset() ||
+            stored->bytesPerPixel() != image->bytesPerPixel()) {
+        stored = ZCameraImagePtr(new ZImageGrayscale(image->width(), image->height(), image->xOffset(), image->yOffset(), image->bytesPerPixel()));
+    }
+
+    stored->setBuffer(image->buffer());
+    stored->setNumber(image->number());
+
+    m_burstStored[size_t(index)] = true;
+}
+
 ZCameraImagePtr ZCameraBase::getNextBufferImage(int width, int height, int xOffset, int yOffset, int bytesPerPixel, void *externalBuffer)
 {
     m_currentImageBufferIndex++;
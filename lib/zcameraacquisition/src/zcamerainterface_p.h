@@ -27,6 +27,12 @@
 #include "zcameraacquisition_global.h"
 #include "zcamerainterface.h"
 
+#include <QAtomicInt>
+#include <QMutex>
+
+#include <deque>
+#include <functional>
+
 namespace Z3D
 {
 
@@ -41,11 +47,19 @@ public:
 
     virtual int bufferSize() override;
 
+    /// getSnapshot creates a copy of the last image
+    virtual bool snapshotIsCopy() override { return true; }
+
 public slots:
     ///
     virtual bool requestSnapshot() override;
     virtual ZCameraImagePtr getSnapshot() override;
 
+    /// software triggered burst, frames come from the regular acquisition
+    virtual bool armBurst(int frameCount) override;
+    virtual bool waitForBurstFrame(int index) override;
+    virtual std::vector<ZCameraImagePtr> getBurst() override;
+
     /// acquisition control
     virtual bool startAcquisition() override;
     virtual bool stopAcquisition() override;
@@ -79,10 +93,40 @@ protected:
 
     ZCameraImagePtr getNextBufferImage(int width, int height, int xOffset, int yOffset, int bytesPerPixel, void *externalBuffer = nullptr);
 
+    /// frames to wait after requestSnapshot before the next image is
+    /// considered fresh. the first frame received might have been exposed
+    /// before the request, so by default we wait for the one after it.
+    /// cameras that update the image synchronously should set this to 0
+    int m_snapshotFrameDelay;
+
 private:
+    /// runs an event loop until isDone returns true or the timeout expires.
+    /// isDone is checked every time a new image is received
+    bool waitForNewImages(const std::function<bool()> &isDone, int timeoutMs = 5000);
+
+    void onNewImageReceived(const ZCameraImagePtr &image);
+    /// m_burstMutex must be locked
+    void storeBurstImage(int index, const ZCameraImagePtr &image);
+
     std::vector<ZCameraImagePtr> m_imagesBuffer;
     int m_currentImageBufferIndex;
 
+    /// frame counting used to wait for a fresh image after requestSnapshot
+    QAtomicInt m_receivedFrameCount;
+    QAtomicInt m_requestedFrameCount;
+
+    /// burst acquisition
+    struct BurstRequest {
+        int index;
+        int frameCount;
+    };
+    QMutex m_burstMutex;
+    bool m_burstArmed;
+    int m_burstNextIndex;
+    std::deque<BurstRequest> m_burstRequests;
+    std::vector<ZCameraImagePtr> m_burstImages;
+    std::vector<bool> m_burstStored;
+
     int m_simultaneousCapturesCount;
 
     /// camera settings
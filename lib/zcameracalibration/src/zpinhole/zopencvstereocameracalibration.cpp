@@ -111,7 +111,10 @@ ZOpenCVStereoCameraCalibration::ZOpenCVStereoCameraCalibration(const cv::Mat cam
                                                                const cv::Mat &F)
     : ZOpenCVStereoCameraCalibration({ ZCameraCalibrationPtr(new ZPinholeCameraCalibration(cameraMatrix[0], distCoeffs[0], imageSize[0])), ZCameraCalibrationPtr(new ZPinholeCameraCalibration(cameraMatrix[1], distCoeffs[1], imageSize[1])) }, {}, {}, cameraMatrix, distCoeffs, imageSize, R, T, E, F)
 {
-
+    /// same poses as when calibrating, the right camera is the world origin
+    const ZCameraCalibrationPtr leftCalibration = calibrations().front();
+    leftCalibration->setRotation(R);
+    leftCalibration->setTranslation(T);
 }
 
 } // namespace Z3D
@@ -3,20 +3,22 @@ include(../../../../NEUVision.pri)
 TEMPLATE      = lib
 CONFIG       += plugin
 QT           -= gui
-QT           += widgets quick
+QT           += widgets quick concurrent
 TARGET        = $$qtLibraryTarget(zbinaryprojectionplugin)
 DESTDIR       = $$Z3D_BUILD_DIR/plugins/structuredlightpatterns
 VERSION       = $$Z3D_VERSION
 
 HEADERS       = \
-    zbinarypatterndecoder.h \
+    zbinarypatternimageprovider.h \
     zbinarypatternprojection.h \
     zbinarypatternprojectionplugin.h \
+    zbinarypatternstreamdecoder.h \
 
 SOURCES       = \
-    zbinarypatterndecoder.cpp \
+    zbinarypatternimageprovider.cpp \
     zbinarypatternprojection.cpp \
     zbinarypatternprojectionplugin.cpp \
+    zbinarypatternstreamdecoder.cpp \
 
 RESOURCES    += \
     resources.qrc
@@ -0,0 +1,121 @@
+//
+// Z3D - A structured light 3D scanner
+// Copyright (C) 2013-2016 Nicolas Ulrich <nikolaseu@gmail.com>
+//
+// This file is part of Z3D.
+//
+// Z3D is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Z3D is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Z3D.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+#include "zbinarypatternimageprovider.h"
+
+#include <QDebug>
+#include <QMutexLocker>
+
+namespace Z3D
+{
+
+ZBinaryPatternImageProvider::ZBinaryPatternImageProvider()
+    : QQuickImageProvider(QQuickImageProvider::Image)
+{
+
+}
+
+int ZBinaryPatternImageProvider::imageCount()
+{
+    return 2 * (PatternBits + 1);
+}
+
+void ZBinaryPatternImageProvider::renderPatterns(const QSize &size, bool vertical, bool isGrayCode)
+{
+    const int maxCode = (1 << PatternBits) - 1;
+    const int length = qMax(1, vertical ? size.width() : size.height());
+
+    /// the code for each position along the pattern, -1 where there's no code
+    /// (outside the patterns, always black). When vertical the patterns are
+    /// rotated 90 degrees, so the code decreases from left to right
+    std::vector<int> codes(size_t(length), -1);
+    for (int i = 0; i < length; ++i) {
+        const int code = vertical ? maxCode - i : i;
+        if (code >= 0 && code <= maxCode) {
+            codes[size_t(i)] = isGrayCode ? (code ^ (code >> 1)) : code;
+        }
+    }
+
+    std::vector<QImage> images;
+    images.reserve(size_t(imageCount()));
+
+    for (int iPattern = 0; iPattern <= PatternBits; ++iPattern) {
+        for (int inverted = 0; inverted < 2; ++inverted) {
+            QImage image = vertical
+                    ? QImage(length, 1, QImage::Format_RGB32)
+                    : QImage(1, length, QImage::Format_RGB32);
+
+            for (int i = 0; i < length; ++i) {
+                const int code = codes[size_t(i)];
+                bool white = false;
+                if (code >= 0) {
+                    /// first pattern is all white, then one bit per pattern,
+                    /// most significant bit first
+                    white = iPattern == 0 || (code & (1 << (PatternBits - iPattern)));
+                    if (inverted) {
+                        white = !white;
+                    }
+                }
+
+                const QRgb color = white ? qRgb(255, 255, 255) : qRgb(0, 0, 0);
+                if (vertical) {
+                    image.setPixel(i, 0, color);
+                } else {
+                    image.setPixel(0, i, color);
+                }
+            }
+
+            images.push_back(image);
+        }
+    }
+
+    QMutexLocker locker(&m_mutex);
+    m_images.swap(images);
+}
+
+QImage ZBinaryPatternImageProvider::requestImage(const QString &id, QSize *size, const QSize &requestedSize)
+{
+    Q_UNUSED(requestedSize)
+
+    QImage image;
+
+    bool ok = false;
+    const int index = id.section('/', -1).toInt(&ok);
+
+    {
+        QMutexLocker locker(&m_mutex);
+        if (ok && index >= 0 && size_t(index) < m_images.size()) {
+            image = m_images[size_t(index)];
+        }
+    }
+
+    if (image.isNull()) {
+        qWarning() << "invalid pattern image requested:" << id;
+    }
+
+    if (size) {
+        *size = image.size();
+    }
+
+    return image;
+}
+
+} // namespace Z3D
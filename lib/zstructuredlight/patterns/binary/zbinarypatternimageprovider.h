@@ -0,0 +1,60 @@
+/* * Z3D - A structured light 3D scanner
+ * Copyright (C) 2013-2016 Nicolas Ulrich <nikolaseu@gmail.com>
+ *
+ * This file is part of Z3D.
+ *
+ * Z3D is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Z3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Z3D.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include <QMutex>
+#include <QQuickImageProvider>
+
+#include <vector>
+
+namespace Z3D
+{
+
+/// Pre-rendered binary patterns for the projection window.
+/// Every pattern (and its inverted version) is rendered once, as a single row
+/// (vertical patterns) or column (horizontal patterns) that is stretched to
+/// fill the window, so switching patterns only changes which of the already
+/// loaded images is visible.
+/// Images are requested as "<version>/<index>", where index is
+/// 2 * pattern + inverted. Version is only used to force QML to reload them.
+class ZBinaryPatternImageProvider : public QQuickImageProvider
+{
+public:
+    /// bits encoded, same as the original 2048 patterns images
+    static const int PatternBits = 11;
+
+    explicit ZBinaryPatternImageProvider();
+
+    /// pattern 0 (all white) plus one pattern per bit, normal and inverted
+    static int imageCount();
+
+    /// render all the patterns for the given projection size
+    void renderPatterns(const QSize &size, bool vertical, bool isGrayCode);
+
+    // QQuickImageProvider interface
+    virtual QImage requestImage(const QString &id, QSize *size, const QSize &requestedSize) override;
+
+private:
+    QMutex m_mutex;
+    std::vector<QImage> m_images;
+};
+
+} // namespace Z3D
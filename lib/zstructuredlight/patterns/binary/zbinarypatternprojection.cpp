@@ -21,12 +21,17 @@
 #include "zbinarypatternprojection.h"
 
 #include "zbinarypatterndecoder.h"
+#include "zbinarypatternimageprovider.h"
+#include "zbinarypatternstreamdecoder.h"
 #include "zcameraimage.h"
 #include "zdecodedpattern.h"
 #include "zprojectedpattern.h"
 
+#include "zparallelutils.h"
+#include "zprojectionutils.h"
 #include "zsettingsitem.h"
 
+#include <opencv2/core.hpp> // repeat
 #include <opencv2/imgcodecs.hpp>
 
 #include <QCoreApplication>
@@ -35,6 +40,7 @@
 #include <QDir>
 #include <QGuiApplication>
 #include <QQmlContext>
+#include <QQmlEngine>
 #include <QQuickView>
 #include <QScreen>
 #include <QThread>
@@ -46,7 +52,12 @@ namespace Z3D
 ZBinaryPatternProjection::ZBinaryPatternProjection(QObject *parent)
     : ZPatternProjection(parent)
     , m_dlpview(nullptr)
+    , m_imageProvider(new ZBinaryPatternImageProvider())
+    , m_patternImagesVersion(0)
     , m_delayMs(500)
+    , m_frameSynchronized(true)
+    , m_settleFrames(2)
+    , m_burstAcquisition(false)
     , m_noiseThreshold(15)
     , m_automaticPatternCount(true)
     , m_numPatterns(11)
@@ -55,8 +66,13 @@ ZBinaryPatternProjection::ZBinaryPatternProjection(QObject *parent)
     , m_inverted(false)
     , m_vertical(true)
     , m_useGrayBinary(true)
+    , m_useInvertedPatterns(true)
+    , m_decodeThreads(0)
     , m_debugMode(false)
     , m_previewEnabled(false)
+    , m_scanUseInvertedPatterns(true)
+    , m_streamDecoder(new ZBinaryPatternStreamDecoder())
+    , m_projectorDecodedImageId(0)
 {
     m_dlpview = new QQuickView();
     m_dlpview->setFlags(Qt::FramelessWindowHint
@@ -67,6 +83,9 @@ ZBinaryPatternProjection::ZBinaryPatternProjection(QObject *parent)
                         //| Qt::WindowStaysOnTopHint
                         );
     m_dlpview->rootContext()->setContextProperty("config", this);
+    /// the engine takes ownership of the image provider
+    m_dlpview->engine()->addImageProvider("binarypattern", m_imageProvider);
+    updatePatternImages();
 //    m_dlpview->rootContext()->setContextProperty("window", m_dlpview);
     m_dlpview->setSource(QUrl("qrc:///zstructuredlight/qml/binarypatternprojection.qml"));
     m_dlpview->setResizeMode(QQuickView::SizeRootObjectToView);
@@ -125,6 +144,12 @@ ZBinaryPatternProjection::ZBinaryPatternProjection(QObject *parent)
     QObject::connect(this, &ZBinaryPatternProjection::useGrayBinaryChanged,
                      useGrayCodeOption.get(), &ZSettingsItem::valueChanged);
 
+    ZSettingsItemPtr useInvertedPatternsOption = std::make_unique<ZSettingsItemBool>(scanConfiguration, "Use inverted patterns", "Project every pattern also inverted. Without them each pattern is compared to the mean of the white and black images, almost halving scan time but it's less robust for shiny or dark parts",
+                                                                                     std::bind(&ZBinaryPatternProjection::useInvertedPatterns, this),
+                                                                                     std::bind(&ZBinaryPatternProjection::setUseInvertedPatterns, this, std::placeholders::_1));
+    QObject::connect(this, &ZBinaryPatternProjection::useInvertedPatternsChanged,
+                     useInvertedPatternsOption.get(), &ZSettingsItem::valueChanged);
+
     ZSettingsItemPtr useVerticalPatternOption = std::make_unique<ZSettingsItemBool>(scanConfiguration, "Vertical patterns", "Use vertical patterns (for example if the projector is rotated or cameras are arranged vertically)",
                                                                                     std::bind(&ZBinaryPatternProjection::vertical, this),
                                                                                     std::bind(&ZBinaryPatternProjection::setVertical, this, std::placeholders::_1));
@@ -150,7 +175,7 @@ ZBinaryPatternProjection::ZBinaryPatternProjection(QObject *parent)
 
     const QString advancedSettings("Advanced settings");
 
-    ZSettingsItemPtr delayOption = std::make_unique<ZSettingsItemInt>(advancedSettings, "Delay", "Delay after projecting pattern (in ms)",
+    ZSettingsItemPtr delayOption = std::make_unique<ZSettingsItemInt>(advancedSettings, "Delay", "Delay after projecting pattern (in ms). When frame synchronized, maximum time to wait for the pattern to be displayed",
                                                                       std::bind(&ZBinaryPatternProjection::delayMs, this),
                                                                       std::bind(&ZBinaryPatternProjection::setDelayMs, this, std::placeholders::_1),
                                                                       0, // minimum
@@ -158,6 +183,29 @@ ZBinaryPatternProjection::ZBinaryPatternProjection(QObject *parent)
     QObject::connect(this, &ZBinaryPatternProjection::delayMsChanged,
                      delayOption.get(), &ZSettingsItem::valueChanged);
 
+    ZSettingsItemPtr frameSynchronizedOption = std::make_unique<ZSettingsItemBool>(advancedSettings, "Frame synchronized", "Wait for the pattern to be displayed and for a new camera frame instead of using a fixed delay",
+                                                                                   std::bind(&ZBinaryPatternProjection::frameSynchronized, this),
+                                                                                   std::bind(&ZBinaryPatternProjection::setFrameSynchronized, this, std::placeholders::_1));
+    QObject::connect(this, &ZBinaryPatternProjection::frameSynchronizedChanged,
+                     frameSynchronizedOption.get(), &ZSettingsItem::valueChanged);
+
+    ZSettingsItemPtr settleFramesOption = std::make_unique<ZSettingsItemInt>(advancedSettings, "Settle frames", "Display refresh periods to wait after the pattern is displayed, to account for projector latency",
+                                                                             std::bind(&ZBinaryPatternProjection::settleFrames, this),
+                                                                             std::bind(&ZBinaryPatternProjection::setSettleFrames, this, std::placeholders::_1),
+                                                                             0, // minimum
+                                                                             60); // maximum
+    QObject::connect(this, &ZBinaryPatternProjection::settleFramesChanged,
+                     settleFramesOption.get(), &ZSettingsItem::valueChanged);
+    QObject::connect(this, &ZBinaryPatternProjection::frameSynchronizedChanged,
+                     settleFramesOption.get(), &ZSettingsItem::setWritable);
+    settleFramesOption->setWritable(frameSynchronized());
+
+    ZSettingsItemPtr burstAcquisitionOption = std::make_unique<ZSettingsItemBool>(advancedSettings, "Burst acquisition", "Arm the cameras for the whole sequence and retrieve all the images at the end of the scan",
+                                                                                  std::bind(&ZBinaryPatternProjection::burstAcquisition, this),
+                                                                                  std::bind(&ZBinaryPatternProjection::setBurstAcquisition, this, std::placeholders::_1));
+    QObject::connect(this, &ZBinaryPatternProjection::burstAcquisitionChanged,
+                     burstAcquisitionOption.get(), &ZSettingsItem::valueChanged);
+
     ZSettingsItemPtr noiseThresholdOption = std::make_unique<ZSettingsItemInt>(advancedSettings, "Noise threshold", "Discard pixels where intensity doesn't change more than threshold value",
                                                                                std::bind(&ZBinaryPatternProjection::noiseThreshold, this),
                                                                                std::bind(&ZBinaryPatternProjection::setNoiseThreshold, this, std::placeholders::_1),
@@ -174,6 +222,14 @@ ZBinaryPatternProjection::ZBinaryPatternProjection(QObject *parent)
     QObject::connect(this, &ZBinaryPatternProjection::intensityChanged,
                      intensityOption.get(), &ZSettingsItem::valueChanged);
 
+    ZSettingsItemPtr decodeThreadsOption = std::make_unique<ZSettingsItemInt>(advancedSettings, "Decode threads", "Number of threads used to decode the patterns (0 = one per core)",
+                                                                              std::bind(&ZBinaryPatternProjection::decodeThreads, this),
+                                                                              std::bind(&ZBinaryPatternProjection::setDecodeThreads, this, std::placeholders::_1),
+                                                                              0, // minimum
+                                                                              64); // maximum
+    QObject::connect(this, &ZBinaryPatternProjection::decodeThreadsChanged,
+                     decodeThreadsOption.get(), &ZSettingsItem::valueChanged);
+
     ZSettingsItemPtr saveDebugInfoOption = std::make_unique<ZSettingsItemBool>(advancedSettings, "Save debug info", "Save extra information for debugging purposes",
                                                                                std::bind(&ZBinaryPatternProjection::debugMode, this),
                                                                                std::bind(&ZBinaryPatternProjection::setDebugMode, this, std::placeholders::_1));
@@ -186,12 +242,17 @@ ZBinaryPatternProjection::ZBinaryPatternProjection(QObject *parent)
         currentPatternOption,
         invertedOption,
         useGrayCodeOption,
+        useInvertedPatternsOption,
         useVerticalPatternOption,
         automaticPatternCountOption,
         patternCountOption,
         delayOption,
+        frameSynchronizedOption,
+        settleFramesOption,
+        burstAcquisitionOption,
         noiseThresholdOption,
         intensityOption,
+        decodeThreadsOption,
         saveDebugInfoOption
     };
 }
@@ -224,6 +285,7 @@ void ZBinaryPatternProjection::setProjectionWindowGeometry(const QRect &geometry
     m_dlpview->setGeometry(geometry);
 
     updateMaxUsefulPatterns();
+    updatePatternImages();
 }
 
 void ZBinaryPatternProjection::beginScan()
@@ -243,7 +305,16 @@ void ZBinaryPatternProjection::beginScan()
 
     QString scanTmpFolder = QString("tmp/dlpscans/%1").arg(QDateTime::currentDateTime().toString("yyyy.MM.dd_hh.mm.ss"));
 
-    emit prepareAcquisition(scanTmpFolder);
+    m_scanUseInvertedPatterns = m_useInvertedPatterns;
+
+    /// frames will be decoded while they arrive, see onImagesAcquired
+    m_streamDecoder->reset(m_noiseThreshold, m_scanUseInvertedPatterns, roi(), autoRoi());
+
+    /// the reference (all white) is always acquired normal and inverted, the
+    /// rest of the patterns only if using the inverted patterns
+    const int patternCount = m_maxUsefulPatterns - qMax(0, firstPatternToShow);
+    const int frameCount = 2 + (m_scanUseInvertedPatterns ? 2 : 1) * patternCount;
+    emit prepareAcquisition(scanTmpFolder, m_burstAcquisition ? frameCount : 0);
 
     setVertical(m_vertical);
 
@@ -260,28 +331,43 @@ void ZBinaryPatternProjection::beginScan()
 
         setCurrentPattern(iPattern);
 
-        for (unsigned int inverted=0; inverted<2; ++inverted) {
+        const unsigned int framesPerPattern = (iPattern == 0 || m_scanUseInvertedPatterns) ? 2 : 1;
+        for (unsigned int inverted=0; inverted<framesPerPattern; ++inverted) {
             setInverted(inverted != 0);
 
-            QCoreApplication::processEvents();
-            QCoreApplication::processEvents();
+            if (m_frameSynchronized) {
+                /// wait until the pattern is on screen and give the projector
+                /// some time to actually display it
+                if (!ProjectionUtils::waitForProjectedFrame(m_dlpview, m_delayMs)) {
+                    qWarning() << "timeout waiting for pattern" << iPattern << "to be displayed";
+                }
 
-            QThread::msleep(ulong(m_delayMs/2));
+                QThread::msleep(ulong(ProjectionUtils::settleTimeMs(m_dlpview, m_settleFrames)));
+            } else {
+                QCoreApplication::processEvents();
+                QCoreApplication::processEvents();
 
-            QCoreApplication::processEvents();
-            QCoreApplication::processEvents();
+                QThread::msleep(ulong(m_delayMs/2));
+
+                QCoreApplication::processEvents();
+                QCoreApplication::processEvents();
+            }
 
             QString fileName = QString("%1_%2%3.png")
                     .arg(m_useGrayBinary?"gray":"binary")
                     .arg(iPattern, 2, 10, QLatin1Char('0'))
                     .arg(inverted?"_inv":"");
 
+            /// when frame synchronized, this returns once the cameras have an
+            /// image exposed after the request, so there's nothing else to wait
             emit acquireSingle(fileName);
 
-            QCoreApplication::processEvents();
-            QCoreApplication::processEvents();
+            if (!m_frameSynchronized) {
+                QCoreApplication::processEvents();
+                QCoreApplication::processEvents();
 
-            QThread::msleep(ulong(m_delayMs/2));
+                QThread::msleep(ulong(m_delayMs/2));
+            }
         }
     }
 
@@ -290,33 +376,31 @@ void ZBinaryPatternProjection::beginScan()
     emit finishAcquisition();
 
     /// create the pattern that was just projected
-    std::map<int, std::vector<cv::Vec2f> > fringePoints;
     const auto geometry = m_dlpview->geometry();
-    const auto projectionHeight = geometry.height();
-    const auto projectionWidth = geometry.width();
+    const int projectionHeight = geometry.height();
+    const int projectionWidth = geometry.width();
     const int fringeStep = int(pow(2, firstPatternToShow));
-    if (m_vertical) {
-        for (int x = fringeStep-1; x<projectionWidth-1; x+=fringeStep) {
-            std::vector<cv::Vec2f> fringe;
-            fringe.reserve(projectionHeight);
-            for (int y = 0; y<projectionHeight; ++y) {
-                fringe.push_back(cv::Vec2f(0.5f+x, y));
-            }
-            fringePoints[x] = fringe;
-        }
-    } else {
-        for (int y = fringeStep-1; y<projectionHeight-1; y+=fringeStep) {
-            std::vector<cv::Vec2f> fringe;
-            fringe.reserve(projectionWidth);
-            for (int x = 0; x<projectionWidth; ++x) {
-                fringe.push_back(cv::Vec2f(x, 0.5f+y));
-            }
-            fringePoints[y] = fringe;
+    /// fringes are across the coding axis, one point per projector pixel
+    const int codeLength = m_vertical ? projectionWidth : projectionHeight;
+    const int fringeLength = m_vertical ? projectionHeight : projectionWidth;
+
+    std::vector<size_t> pointsPerCode(size_t(qMax(0, codeLength)), 0);
+    for (int code = fringeStep-1; code<codeLength-1; code+=fringeStep) {
+        pointsPerCode[size_t(code)] = size_t(fringeLength);
+    }
+
+    ZFringePoints fringePoints;
+    fringePoints.allocate(pointsPerCode);
+    for (int code = fringeStep-1; code<codeLength-1; code+=fringeStep) {
+        for (int i = 0; i<fringeLength; ++i) {
+            fringePoints.addPoint(code, m_vertical
+                                  ? cv::Vec2f(0.5f+code, i)
+                                  : cv::Vec2f(i, 0.5f+code));
         }
     }
-    qDebug() << "pattern has" << fringePoints.size() << "fringes";
+    qDebug() << "pattern has" << fringePoints.fringeCount() << "fringes";
 
-    const Z3D::ZProjectedPatternPtr pattern(new Z3D::ZProjectedPattern(cv::Mat(), fringePoints));
+    const Z3D::ZProjectedPatternPtr pattern(new Z3D::ZProjectedPattern(projectorDecodedImage(firstPatternToShow), std::move(fringePoints), m_projectorDecodedImageId));
 
     /// notify possible listeners
     emit patternProjected(pattern);
@@ -331,9 +415,118 @@ void ZBinaryPatternProjection::processImages(std::vector<std::vector<ZCameraImag
     ///     1st index: image number / order
     ///     2nd index: camera index
     auto numImages = acquiredImages.size();
-    auto numPatterns = numImages / 2;
     auto numCameras = acquiredImages.front().size();
 
+    /// decodification time
+    QTime decodeTime;
+    decodeTime.start();
+
+    std::vector<Z3D::ZDecodedPatternPtr> decodedPatternList;
+
+    /// most of the work should already be done if every frame went through the stream decoder
+    if (m_streamDecoder->isValid()
+            && size_t(m_streamDecoder->frameCount()) == numImages
+            && size_t(m_streamDecoder->cameraCount()) == numCameras) {
+        decodedPatternList = m_streamDecoder->finish(m_useGrayBinary, m_decodeThreads,
+                                                     decodedImageType((1 << ZBinaryPatternImageProvider::PatternBits) - 1));
+    }
+
+    if (decodedPatternList.size() != numCameras) {
+        qDebug() << "stream decoding not available, decoding all images";
+        decodedPatternList = decodeAllImages(acquiredImages);
+    }
+
+    if (m_debugMode) {
+        for (size_t iCam=0; iCam<decodedPatternList.size(); ++iCam) {
+            cv::imwrite(qPrintable(QString("%1/decoded_%2.tiff")
+                                   .arg(scanId)
+                                   .arg(iCam)),
+                        decodedPatternList[iCam]->decodedImage());
+        }
+    }
+
+    qDebug() << "pattern decodification finished in" << decodeTime.elapsed() << "msecs";
+
+    /// notify result
+    emit patternsDecoded(decodedPatternList);
+}
+
+cv::Mat ZBinaryPatternProjection::projectorDecodedImage(int firstPattern)
+{
+    const QSize size = m_dlpview->geometry().size();
+    const QString key = QString("%1x%2 vertical:%3 gray:%4 patterns:%5-%6")
+            .arg(size.width()).arg(size.height())
+            .arg(m_vertical).arg(m_useGrayBinary)
+            .arg(firstPattern).arg(m_maxUsefulPatterns);
+    if (key == m_projectorDecodedImageKey) {
+        return m_projectorDecodedImage;
+    }
+
+    /// the patterns are the same along the fringes, so only one line along
+    /// the coding axis is rendered (with the same codes used to render the
+    /// patterns) and decoded like the camera images, so both have exactly
+    /// the same codes
+    const int bits = ZBinaryPatternImageProvider::PatternBits;
+    const int maxCode = (1 << bits) - 1;
+    const int length = qMax(1, m_vertical ? size.width() : size.height());
+
+    cv::Mat maskImg(1, length, CV_8UC1, cv::Scalar(0));
+    std::vector<cv::Mat> images;
+    std::vector<cv::Mat> invImages;
+    for (int iPattern = qMax(1, firstPattern + 1); iPattern <= m_maxUsefulPatterns; ++iPattern) {
+        cv::Mat image(1, length, CV_8UC1, cv::Scalar(0));
+        for (int i = 0; i < length; ++i) {
+            const int code = m_vertical ? maxCode - i : i;
+            if (code < 0 || code > maxCode) {
+                continue;
+            }
+            const int projectedCode = m_useGrayBinary ? (code ^ (code >> 1)) : code;
+            image.at<uint8_t>(0, i) = (projectedCode & (1 << (bits - iPattern))) ? 255 : 0;
+            maskImg.at<uint8_t>(0, i) = 255;
+        }
+        invImages.push_back(255 - image);
+        images.push_back(image);
+    }
+
+    if (images.empty()) {
+        qWarning() << "no patterns to decode for" << key;
+        return cv::Mat();
+    }
+
+    /// it's only computed once, floating point is easier to use later
+    cv::Mat decodedLine = ZBinaryPatternDecoder::decodeBinaryPatternImages(images, invImages, maskImg, m_useGrayBinary,
+                                                                           nullptr, cv::Rect(), CV_32FC1);
+
+    /// and then repeated along the fringes
+    /// always in a new image, the previous one is shared with the patterns
+    /// already projected and cv::repeat would reuse its buffer
+    cv::Mat projectorDecodedImage;
+    if (m_vertical) {
+        cv::repeat(decodedLine, size.height(), 1, projectorDecodedImage);
+    } else {
+        cv::repeat(decodedLine.t(), 1, size.width(), projectorDecodedImage);
+    }
+    m_projectorDecodedImage = projectorDecodedImage;
+    m_projectorDecodedImageKey = key;
+    m_projectorDecodedImageId = ZProjectedPattern::newDecodedImageId();
+
+    qDebug() << "projector decoded image updated for" << key;
+
+    return m_projectorDecodedImage;
+}
+
+std::vector<ZDecodedPatternPtr> ZBinaryPatternProjection::decodeAllImages(const std::vector<std::vector<ZCameraImagePtr> > &acquiredImages) const
+{
+    /// acquiredImages indexing
+    ///     1st index: image number / order
+    ///     2nd index: camera index
+    auto numImages = acquiredImages.size();
+    auto numCameras = acquiredImages.front().size();
+
+    /// the reference pair always has the inverted (all black) image
+    const size_t framesPerPattern = m_scanUseInvertedPatterns ? 2 : 1;
+    auto numPatterns = 1 + (numImages - 2) / framesPerPattern;
+
     /// allImages indexing
     ///     1st index: camera
     ///     2nd index: normal/inverted
@@ -346,59 +539,91 @@ void ZBinaryPatternProjection::processImages(std::vector<std::vector<ZCameraImag
         allImages[iCam][0].resize(numPatterns); // images
         allImages[iCam][1].resize(numPatterns); // inverted images
 
-        for (unsigned int iPattern=0; iPattern<numPatterns; ++iPattern) {
-            int imageIndex = 2 * iPattern;
-            allImages[iCam][0][iPattern] = acquiredImages[imageIndex  ][iCam]->cvMat();
-            allImages[iCam][1][iPattern] = acquiredImages[imageIndex+1][iCam]->cvMat();
+        allImages[iCam][0][0] = acquiredImages[0][iCam]->cvMat();
+        allImages[iCam][1][0] = acquiredImages[1][iCam]->cvMat();
+
+        /// without the inverted patterns, every pattern is compared to the
+        /// threshold computed from the reference pair
+        const cv::Mat thresholdImg = m_scanUseInvertedPatterns
+                ? cv::Mat()
+                : ZBinaryPatternDecoder::binaryThresholdImage(allImages[iCam][0][0], allImages[iCam][1][0]);
+
+        for (unsigned int iPattern=1; iPattern<numPatterns; ++iPattern) {
+            const size_t imageIndex = 2 + framesPerPattern * (iPattern - 1);
+            allImages[iCam][0][iPattern] = acquiredImages[imageIndex][iCam]->cvMat();
+            allImages[iCam][1][iPattern] = m_scanUseInvertedPatterns
+                    ? acquiredImages[imageIndex+1][iCam]->cvMat()
+                    : thresholdImg;
         }
     }
 
-    /// decodification time
-    QTime decodeTime;
-    decodeTime.start();
-
-    std::vector<Z3D::ZDecodedPatternPtr> decodedPatternList;
+    std::vector<cv::Mat> maskImages(numCameras);
+    std::vector<cv::Mat> intensityImages(numCameras);
+    std::vector<cv::Mat> decodedImages(numCameras);
+    std::vector<cv::Mat> confidenceImages(numCameras);
+    std::vector<cv::Rect> roiRects(numCameras);
+    std::vector<int> imageRows(numCameras);
+    const int decodedType = decodedImageType((1 << ZBinaryPatternImageProvider::PatternBits) - 1);
 
     for (unsigned int iCam=0; iCam<numCameras; ++iCam) {
-        /// decode images
-
         auto &cameraImages = allImages[iCam];
         auto &whiteImages = cameraImages[0];
         auto &inverseImages = cameraImages[1];
 
         /// the first images are the all white, all black
         /// they are used to create the mask of valid pixels
-        const cv::Mat &whiteImg = whiteImages.front();
-        const cv::Mat &inverseImg = inverseImages.front();
+        const cv::Mat whiteImg = whiteImages.front();
+        const cv::Mat inverseImg = inverseImages.front();
 
-        cv::Mat maskImg = whiteImg - inverseImg;
-        /// set mask to keep only values greater than threshold
-        maskImg = maskImg > m_noiseThreshold;
+        /// only the region of interest is decoded
+        cv::Rect &roi = roiRects[iCam];
+        roi = this->roi();
+        maskImages[iCam] = ZBinaryPatternDecoder::referenceMaskImage(whiteImg, inverseImg, m_noiseThreshold, roi, autoRoi());
 
-        auto intensityImg = whiteImg.clone();
+        intensityImages[iCam] = whiteImg.clone();
 
         /// the first images are useless to decode pattern
         whiteImages.erase(whiteImages.begin());
         inverseImages.erase(inverseImages.begin());
 
-        /// decode binary pattern using the rest of the images
-        cv::Mat decoded = Z3D::ZBinaryPatternDecoder::decodeBinaryPatternImages(whiteImages, inverseImages, maskImg, m_useGrayBinary);
+        for (size_t iPattern=0; iPattern<whiteImages.size(); ++iPattern) {
+            whiteImages[iPattern] = whiteImages[iPattern](roi);
+            inverseImages[iPattern] = inverseImages[iPattern](roi);
+        }
 
-        if (m_debugMode) {
-            cv::imwrite(qPrintable(QString("%1/decoded_%2.tiff")
-                                   .arg(scanId)
-                                   .arg(iCam)),
-                        decoded);
+        decodedImages[iCam] = cv::Mat(whiteImg.size(), decodedType);
+        confidenceImages[iCam] = cv::Mat(whiteImg.size(), CV_8UC1);
+        if (roi.size() != whiteImg.size()) {
+            decodedImages[iCam].setTo(Z3D::ZDecodedPattern::noValue(decodedType));
+            confidenceImages[iCam].setTo(0);
         }
+        imageRows[iCam] = roi.height;
+    }
 
-        Z3D::ZDecodedPatternPtr decodedPattern(new Z3D::ZDecodedPattern(decoded, intensityImg));
+    /// decode binary pattern using the rest of the images.
+    /// All the cameras are decoded at the same time, by bands of rows
+    ParallelUtils::forEachRowBand(imageRows, [&](int iCam, int rowBegin, int rowEnd) {
+        const cv::Rect &roi = roiRects[size_t(iCam)];
+        const auto &cameraImages = allImages[size_t(iCam)];
+        Z3D::ZBinaryPatternDecoder::decodeBinaryPatternImageRows(cameraImages[0], cameraImages[1], maskImages[size_t(iCam)], m_useGrayBinary,
+                                                                 decodedImages[size_t(iCam)](roi), rowBegin, rowEnd,
+                                                                 confidenceImages[size_t(iCam)](roi));
+    }, m_decodeThreads);
+
+    std::vector<Z3D::ZDecodedPatternPtr> decodedPatternList;
+    for (unsigned int iCam=0; iCam<numCameras; ++iCam) {
+        Z3D::ZDecodedPatternPtr decodedPattern(new Z3D::ZDecodedPattern(decodedImages[iCam], intensityImages[iCam], confidenceImages[iCam], roiRects[iCam]));
         decodedPatternList.push_back(decodedPattern);
     }
 
-    qDebug() << "pattern decodification finished in" << decodeTime.elapsed() << "msecs";
+    return decodedPatternList;
+}
 
-    /// notify result
-    emit patternsDecoded(decodedPatternList);
+void ZBinaryPatternProjection::onImagesAcquired(std::vector<ZCameraImagePtr> images, QString id)
+{
+    Q_UNUSED(id)
+
+    m_streamDecoder->addImages(images);
 }
 
 double ZBinaryPatternProjection::intensity()
@@ -431,6 +656,7 @@ bool ZBinaryPatternProjection::setCurrentPattern(int arg)
 
     m_currentPattern = arg;
     emit currentPatternChanged(arg);
+    emit patternImageIndexChanged(patternImageIndex());
 
     return true;
 }
@@ -448,6 +674,7 @@ bool ZBinaryPatternProjection::setInverted(bool arg)
 
     m_inverted = arg;
     emit invertedChanged(arg);
+    emit patternImageIndexChanged(patternImageIndex());
 
     return true;
 }
@@ -466,6 +693,7 @@ bool ZBinaryPatternProjection::setVertical(bool arg)
     m_vertical = arg;
     emit verticalChanged(arg);
     updateMaxUsefulPatterns();
+    updatePatternImages();
 
     return true;
 }
@@ -483,6 +711,24 @@ bool ZBinaryPatternProjection::setUseGrayBinary(bool arg)
 
     m_useGrayBinary = arg;
     emit useGrayBinaryChanged(arg);
+    updatePatternImages();
+
+    return true;
+}
+
+bool ZBinaryPatternProjection::useInvertedPatterns() const
+{
+    return m_useInvertedPatterns;
+}
+
+bool ZBinaryPatternProjection::setUseInvertedPatterns(bool arg)
+{
+    if (m_useInvertedPatterns == arg) {
+        return true;
+    }
+
+    m_useInvertedPatterns = arg;
+    emit useInvertedPatternsChanged(arg);
 
     return true;
 }
@@ -504,6 +750,57 @@ bool ZBinaryPatternProjection::setDelayMs(int arg)
     return true;
 }
 
+bool ZBinaryPatternProjection::frameSynchronized() const
+{
+    return m_frameSynchronized;
+}
+
+bool ZBinaryPatternProjection::setFrameSynchronized(bool arg)
+{
+    if (m_frameSynchronized == arg) {
+        return true;
+    }
+
+    m_frameSynchronized = arg;
+    emit frameSynchronizedChanged(arg);
+
+    return true;
+}
+
+int ZBinaryPatternProjection::settleFrames() const
+{
+    return m_settleFrames;
+}
+
+bool ZBinaryPatternProjection::setSettleFrames(int arg)
+{
+    if (m_settleFrames == arg) {
+        return true;
+    }
+
+    m_settleFrames = arg;
+    emit settleFramesChanged(arg);
+
+    return true;
+}
+
+bool ZBinaryPatternProjection::burstAcquisition() const
+{
+    return m_burstAcquisition;
+}
+
+bool ZBinaryPatternProjection::setBurstAcquisition(bool arg)
+{
+    if (m_burstAcquisition == arg) {
+        return true;
+    }
+
+    m_burstAcquisition = arg;
+    emit burstAcquisitionChanged(arg);
+
+    return true;
+}
+
 int ZBinaryPatternProjection::noiseThreshold() const
 {
     return m_noiseThreshold;
@@ -544,6 +841,23 @@ bool ZBinaryPatternProjection::setNumPatterns(int arg)
     return true;
 }
 
+int ZBinaryPatternProjection::decodeThreads() const
+{
+    return m_decodeThreads;
+}
+
+bool ZBinaryPatternProjection::setDecodeThreads(int arg)
+{
+    if (m_decodeThreads == arg) {
+        return true;
+    }
+
+    m_decodeThreads = arg;
+    emit decodeThreadsChanged(arg);
+
+    return true;
+}
+
 bool ZBinaryPatternProjection::debugMode() const
 {
     return m_debugMode;
@@ -583,6 +897,21 @@ bool ZBinaryPatternProjection::setPreviewEnabled(bool arg)
     return previousPreviewState;
 }
 
+int ZBinaryPatternProjection::patternImageCount() const
+{
+    return ZBinaryPatternImageProvider::imageCount();
+}
+
+int ZBinaryPatternProjection::patternImageIndex() const
+{
+    return 2 * m_currentPattern + (m_inverted ? 1 : 0);
+}
+
+int ZBinaryPatternProjection::patternImagesVersion() const
+{
+    return m_patternImagesVersion;
+}
+
 bool ZBinaryPatternProjection::automaticPatternCount() const
 {
     return m_automaticPatternCount;
@@ -645,4 +974,12 @@ void ZBinaryPatternProjection::updateMaxUsefulPatterns()
     setAutomaticPatternCount(m_automaticPatternCount);
 }
 
+void ZBinaryPatternProjection::updatePatternImages()
+{
+    m_imageProvider->renderPatterns(m_dlpview->geometry().size(), m_vertical, m_useGrayBinary);
+
+    /// make QML reload the images
+    emit patternImagesVersionChanged(++m_patternImagesVersion);
+}
+
 } // namespace Z3D
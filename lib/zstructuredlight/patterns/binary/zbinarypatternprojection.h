@@ -21,18 +21,25 @@
 
 #include "zpatternprojection.h"
 
+#include <opencv2/core/mat.hpp>
+
 class QQuickView;
 
 namespace Z3D
 {
 
+class ZBinaryPatternImageProvider;
 class ZBinaryPatternProjectionConfigWidget;
+class ZBinaryPatternStreamDecoder;
 
 class ZBinaryPatternProjection : public ZPatternProjection
 {
     Q_OBJECT
 
     Q_PROPERTY(int delayMs READ delayMs WRITE setDelayMs NOTIFY delayMsChanged)
+    Q_PROPERTY(bool frameSynchronized READ frameSynchronized WRITE setFrameSynchronized NOTIFY frameSynchronizedChanged)
+    Q_PROPERTY(int settleFrames READ settleFrames WRITE setSettleFrames NOTIFY settleFramesChanged)
+    Q_PROPERTY(bool burstAcquisition READ burstAcquisition WRITE setBurstAcquisition NOTIFY burstAcquisitionChanged)
     Q_PROPERTY(int noiseThreshold READ noiseThreshold WRITE setNoiseThreshold NOTIFY noiseThresholdChanged)
     Q_PROPERTY(bool automaticPatternCount READ automaticPatternCount WRITE setAutomaticPatternCount NOTIFY automaticPatternCountChanged)
     Q_PROPERTY(int numPatterns READ numPatterns WRITE setNumPatterns NOTIFY numPatternsChanged)
@@ -41,8 +48,13 @@ class ZBinaryPatternProjection : public ZPatternProjection
     Q_PROPERTY(bool inverted READ inverted WRITE setInverted NOTIFY invertedChanged)
     Q_PROPERTY(bool vertical READ vertical WRITE setVertical NOTIFY verticalChanged)
     Q_PROPERTY(bool useGrayBinary READ useGrayBinary WRITE setUseGrayBinary NOTIFY useGrayBinaryChanged)
+    Q_PROPERTY(bool useInvertedPatterns READ useInvertedPatterns WRITE setUseInvertedPatterns NOTIFY useInvertedPatternsChanged)
+    Q_PROPERTY(int decodeThreads READ decodeThreads WRITE setDecodeThreads NOTIFY decodeThreadsChanged)
     Q_PROPERTY(bool debugMode READ debugMode WRITE setDebugMode NOTIFY debugModeChanged)
     Q_PROPERTY(bool previewEnabled READ previewEnabled WRITE setPreviewEnabled NOTIFY previewEnabledChanged)
+    Q_PROPERTY(int patternImageCount READ patternImageCount CONSTANT)
+    Q_PROPERTY(int patternImageIndex READ patternImageIndex NOTIFY patternImageIndexChanged)
+    Q_PROPERTY(int patternImagesVersion READ patternImagesVersion NOTIFY patternImagesVersionChanged)
 
 public:
     explicit ZBinaryPatternProjection(QObject *parent = nullptr);
@@ -58,17 +70,25 @@ signals:
     void invertedChanged(bool);
     void verticalChanged(bool);
     void useGrayBinaryChanged(bool);
+    void useInvertedPatternsChanged(bool arg);
     void delayMsChanged(int arg);
+    void frameSynchronizedChanged(bool arg);
+    void settleFramesChanged(int arg);
+    void burstAcquisitionChanged(bool arg);
     void noiseThresholdChanged(int arg);
     void numPatternsChanged(int arg);
+    void decodeThreadsChanged(int arg);
     void debugModeChanged(bool arg);
     void previewEnabledChanged(bool arg);
     void automaticPatternCountChanged(bool arg);
+    void patternImageIndexChanged(int arg);
+    void patternImagesVersionChanged(int arg);
 
 public slots:
     // ZPatternProjection interface
     virtual void beginScan() override;
     virtual void processImages(std::vector< std::vector<Z3D::ZCameraImagePtr> > acquiredImages, QString scanId) override;
+    virtual void onImagesAcquired(std::vector<Z3D::ZCameraImagePtr> images, QString id) override;
 
     void showProjectionWindow();
     void hideProjectionWindow();
@@ -89,15 +109,30 @@ public slots:
     bool useGrayBinary();
     bool setUseGrayBinary(bool arg);
 
+    bool useInvertedPatterns() const;
+    bool setUseInvertedPatterns(bool arg);
+
     int delayMs() const;
     bool setDelayMs(int arg);
 
+    bool frameSynchronized() const;
+    bool setFrameSynchronized(bool arg);
+
+    int settleFrames() const;
+    bool setSettleFrames(int arg);
+
+    bool burstAcquisition() const;
+    bool setBurstAcquisition(bool arg);
+
     int noiseThreshold() const;
     bool setNoiseThreshold(int arg);
 
     int numPatterns() const;
     bool setNumPatterns(int arg);
 
+    int decodeThreads() const;
+    bool setDecodeThreads(int arg);
+
     bool debugMode() const;
     bool setDebugMode(bool arg);
 
@@ -107,16 +142,32 @@ public slots:
     bool automaticPatternCount() const;
     bool setAutomaticPatternCount(bool arg);
 
+    int patternImageCount() const;
+    int patternImageIndex() const;
+    int patternImagesVersion() const;
+
 private slots:
     int selectedScreen() const;
     bool setSelectedScreen(int index);
 
 protected:
     void updateMaxUsefulPatterns();
+    void updatePatternImages();
+
+    std::vector<Z3D::ZDecodedPatternPtr> decodeAllImages(const std::vector< std::vector<Z3D::ZCameraImagePtr> > &acquiredImages) const;
+
+    /// decoded image as seen from the projector, i.e. the code of every
+    /// projector pixel, for patterns firstPattern+1 to m_maxUsefulPatterns
+    cv::Mat projectorDecodedImage(int firstPattern);
 
     QQuickView *m_dlpview;
+    ZBinaryPatternImageProvider *m_imageProvider;
+    int m_patternImagesVersion;
 
     int m_delayMs;
+    bool m_frameSynchronized;
+    int m_settleFrames;
+    bool m_burstAcquisition;
     int m_noiseThreshold;
     bool m_automaticPatternCount;
     int m_numPatterns;
@@ -125,12 +176,24 @@ protected:
     bool m_inverted;
     bool m_vertical;
     bool m_useGrayBinary;
+    bool m_useInvertedPatterns;
+    int m_decodeThreads;
 
     bool m_debugMode;
     bool m_previewEnabled;
 
     int m_maxUsefulPatterns;
 
+    /// whether the last scan projected the inverted patterns, needed to decode it
+    bool m_scanUseInvertedPatterns;
+
+    std::unique_ptr<ZBinaryPatternStreamDecoder> m_streamDecoder;
+
+    /// only changes with the projector geometry and the pattern settings
+    cv::Mat m_projectorDecodedImage;
+    QString m_projectorDecodedImageKey;
+    uint64_t m_projectorDecodedImageId;
+
     std::vector<ZSettingsItemPtr> m_settings;
 };
 
@@ -0,0 +1,204 @@
+//
+// Z3D - A structured light 3D scanner
+// Copyright (C) 2013-2016 Nicolas Ulrich <nikolaseu@gmail.com>
+//
+// This file is part of Z3D.
+//
+// Z3D is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Z3D is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Z3D.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "zbinarypatternstreamdecoder.h"
+
+#include "zbinarypatterndecoder.h"
+#include "zdecodedpattern.h"
+#include "zparallelutils.h"
+
+#include <QDebug>
+#include <QtConcurrentRun>
+
+#include <limits>
+
+namespace Z3D
+{
+
+ZBinaryPatternStreamDecoder::ZBinaryPatternStreamDecoder()
+    : m_noiseThreshold(0)
+    , m_useInvertedPatterns(true)
+    , m_autoRoi(false)
+    , m_frameCount(0)
+    , m_valid(false)
+{
+
+}
+
+ZBinaryPatternStreamDecoder::~ZBinaryPatternStreamDecoder()
+{
+    waitForPendingWork();
+}
+
+void ZBinaryPatternStreamDecoder::reset(int noiseThreshold, bool useInvertedPatterns, const cv::Rect &roi, bool autoRoi)
+{
+    waitForPendingWork();
+
+    m_cameras.clear();
+    m_noiseThreshold = noiseThreshold;
+    m_useInvertedPatterns = useInvertedPatterns;
+    m_roi = roi;
+    m_autoRoi = autoRoi;
+    m_frameCount = 0;
+    m_valid = true;
+}
+
+void ZBinaryPatternStreamDecoder::addImages(const std::vector<ZCameraImagePtr> &images)
+{
+    if (!m_valid) {
+        return;
+    }
+
+    if (m_cameras.empty()) {
+        m_cameras.resize(images.size());
+    }
+
+    if (images.size() != m_cameras.size()) {
+        qWarning() << "camera count changed while streaming, expected" << m_cameras.size() << "got" << images.size();
+        m_valid = false;
+        return;
+    }
+
+    const bool isReferencePair = m_frameCount < 2;
+    /// the first image of each pair is kept until the second one arrives
+    const bool isFirstOfPair = (isReferencePair || m_useInvertedPatterns) && m_frameCount % 2 == 0;
+
+    for (size_t iCam=0; iCam<images.size(); ++iCam) {
+        const auto &image = images[iCam];
+        if (!image) {
+            qWarning() << "missing image for camera" << iCam << ", stream decoding disabled for this scan";
+            m_valid = false;
+            return;
+        }
+
+        auto &camera = m_cameras[iCam];
+        if (isFirstOfPair) {
+            camera.pendingImage = image->cvMat();
+            continue;
+        }
+
+        const bool hasPair = isReferencePair || m_useInvertedPatterns;
+        const cv::Mat whiteImg = hasPair ? camera.pendingImage : image->cvMat();
+        const cv::Mat inverseImg = hasPair ? image->cvMat() : cv::Mat();
+        camera.pendingImage = cv::Mat();
+
+        /// codeImg is updated in place, so the previous pair of this camera
+        /// must be finished before starting with the next one
+        camera.future.waitForFinished();
+
+        CameraStream *cameraPtr = &camera;
+        const int noiseThreshold = m_noiseThreshold;
+        const bool useInvertedPatterns = m_useInvertedPatterns;
+        if (isReferencePair) {
+            const cv::Rect roi = m_roi;
+            const bool autoRoi = m_autoRoi;
+            camera.future = QtConcurrent::run([=]() {
+                /// everything after this only uses the region of interest
+                cameraPtr->roi = roi;
+                cameraPtr->maskImg = ZBinaryPatternDecoder::referenceMaskImage(whiteImg, inverseImg, noiseThreshold, cameraPtr->roi, autoRoi);
+                cameraPtr->intensityImg = whiteImg.clone();
+                if (!useInvertedPatterns) {
+                    cameraPtr->thresholdImg = ZBinaryPatternDecoder::binaryThresholdImage(whiteImg(cameraPtr->roi), inverseImg(cameraPtr->roi));
+                }
+                /// the confidence of the first bit starts from the maximum
+                cameraPtr->confidenceImg = cv::Mat(whiteImg.size(), CV_8UC1, cv::Scalar(0));
+                cameraPtr->confidenceImg(cameraPtr->roi).setTo(std::numeric_limits<uint8_t>::max());
+            });
+        } else {
+            camera.future = QtConcurrent::run([=]() {
+                const cv::Rect &roi = cameraPtr->roi;
+                /// the threshold image is used in place of the inverted one
+                const cv::Mat referenceImg = useInvertedPatterns ? inverseImg(roi) : cameraPtr->thresholdImg;
+                cv::Mat confidenceImg = cameraPtr->confidenceImg(roi);
+                ZBinaryPatternDecoder::accumulateBinaryPatternImage(whiteImg(roi), referenceImg, cameraPtr->maskImg, cameraPtr->codeImg, confidenceImg);
+            });
+        }
+    }
+
+    ++m_frameCount;
+}
+
+bool ZBinaryPatternStreamDecoder::isValid() const
+{
+    return m_valid;
+}
+
+int ZBinaryPatternStreamDecoder::frameCount() const
+{
+    return m_frameCount;
+}
+
+int ZBinaryPatternStreamDecoder::cameraCount() const
+{
+    return int(m_cameras.size());
+}
+
+std::vector<ZDecodedPatternPtr> ZBinaryPatternStreamDecoder::finish(bool isGrayCode, int maxThreads, int decodedType)
+{
+    waitForPendingWork();
+
+    std::vector<ZDecodedPatternPtr> decodedPatternList;
+
+    /// we need at least the reference pair and one pattern, all complete
+    const int patternFrames = m_frameCount - 2;
+    const int framesPerPattern = m_useInvertedPatterns ? 2 : 1;
+    if (!m_valid || patternFrames < framesPerPattern || patternFrames % framesPerPattern) {
+        m_valid = false;
+        return decodedPatternList;
+    }
+
+    std::vector<cv::Mat> decodedImages(m_cameras.size());
+    std::vector<int> imageRows(m_cameras.size());
+    for (size_t iCam=0; iCam<m_cameras.size(); ++iCam) {
+        const CameraStream &camera = m_cameras[iCam];
+        /// codes are only accumulated inside the region of interest
+        decodedImages[iCam] = cv::Mat(camera.intensityImg.size(), decodedType);
+        if (camera.roi.size() != camera.intensityImg.size()) {
+            decodedImages[iCam].setTo(ZDecodedPattern::noValue(decodedType));
+        }
+        imageRows[iCam] = camera.codeImg.rows;
+    }
+
+    ParallelUtils::forEachRowBand(imageRows, [&](int iCam, int rowBegin, int rowEnd) {
+        const CameraStream &camera = m_cameras[size_t(iCam)];
+        ZBinaryPatternDecoder::finishBinaryPatternDecodingRows(camera.codeImg, camera.maskImg, isGrayCode,
+                                                               decodedImages[size_t(iCam)](camera.roi), rowBegin, rowEnd);
+    }, maxThreads);
+
+    decodedPatternList.reserve(m_cameras.size());
+    for (size_t iCam=0; iCam<m_cameras.size(); ++iCam) {
+        const CameraStream &camera = m_cameras[iCam];
+        decodedPatternList.push_back(ZDecodedPatternPtr(new ZDecodedPattern(decodedImages[iCam], camera.intensityImg, camera.confidenceImg, camera.roi)));
+    }
+
+    /// the accumulated codes were consumed, don't allow to finish twice
+    m_valid = false;
+
+    return decodedPatternList;
+}
+
+void ZBinaryPatternStreamDecoder::waitForPendingWork()
+{
+    for (auto &camera : m_cameras) {
+        camera.future.waitForFinished();
+    }
+}
+
+} // namespace Z3D
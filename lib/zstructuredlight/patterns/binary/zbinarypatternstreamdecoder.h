@@ -0,0 +1,95 @@
+/* * Z3D - A structured light 3D scanner
+ * Copyright (C) 2013-2016 Nicolas Ulrich <nikolaseu@gmail.com>
+ *
+ * This file is part of Z3D.
+ *
+ * Z3D is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Z3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Z3D.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include "zstructuredlight_fwd.h"
+
+#include <zcameraimage.h>
+
+#include <opencv2/core/mat.hpp>
+
+#include <QFuture>
+
+#include <vector>
+
+namespace Z3D
+{
+
+/// Decodes binary patterns while they are being acquired.
+/// Frames must be added in the same order they are projected: first the all
+/// white/all black pair (used for the mask and the intensity image), then each
+/// normal/inverted pattern pair, most significant bit first. When the inverted
+/// patterns are not used there's only one frame per pattern, decoded using the
+/// threshold computed from the white/black pair.
+/// Each pattern is accumulated in a worker thread so when the last frame arrives
+/// only the final (gray code + hole filling) pass is left to do.
+/// Only the region of interest of each camera is decoded, it's known as soon
+/// as the white/black pair is available.
+class ZBinaryPatternStreamDecoder
+{
+public:
+    explicit ZBinaryPatternStreamDecoder();
+    ~ZBinaryPatternStreamDecoder();
+
+    /// discard everything and start a new stream. roi is the region of the
+    /// images to decode (empty means the whole image), reduced to the pixels
+    /// lit by the projector if autoRoi is true
+    void reset(int noiseThreshold, bool useInvertedPatterns = true, const cv::Rect &roi = cv::Rect(), bool autoRoi = false);
+
+    /// add one frame, one image per camera
+    void addImages(const std::vector<ZCameraImagePtr> &images);
+
+    /// true if every frame added so far could be used
+    bool isValid() const;
+
+    int frameCount() const;
+    int cameraCount() const;
+
+    /// waits for pending work and returns the decoded pattern for each camera,
+    /// using up to maxThreads threads (0 means one per core), as decodedType
+    /// (CV_16UC1 or CV_32FC1) images.
+    /// The stream must be reset before being used again
+    std::vector<ZDecodedPatternPtr> finish(bool isGrayCode, int maxThreads = 0, int decodedType = CV_16UC1);
+
+private:
+    struct CameraStream {
+        cv::Mat pendingImage;
+        cv::Mat maskImg;
+        cv::Mat intensityImg;
+        cv::Mat thresholdImg;
+        cv::Mat codeImg;
+        cv::Mat confidenceImg;
+        cv::Rect roi;
+        QFuture<void> future;
+    };
+
+    void waitForPendingWork();
+
+    std::vector<CameraStream> m_cameras;
+    int m_noiseThreshold;
+    bool m_useInvertedPatterns;
+    cv::Rect m_roi;
+    bool m_autoRoi;
+    int m_frameCount;
+    bool m_valid;
+};
+
+} // namespace Z3D
@@ -0,0 +1,42 @@
+include(../../../../NEUVision.pri)
+
+TEMPLATE      = lib
+CONFIG       += plugin
+QT           -= gui
+QT           += widgets quick concurrent
+TARGET        = $$qtLibraryTarget(zphaseshiftprojectionplugin)
+DESTDIR       = $$Z3D_BUILD_DIR/plugins/structuredlightpatterns
+VERSION       = $$Z3D_VERSION
+
+HEADERS       = \
+    zphaseshiftpatterndecoder.h \
+    zphaseshiftpatternimageprovider.h \
+    zphaseshiftpatternprojection.h \
+    zphaseshiftpatternprojectionplugin.h \
+
+SOURCES       = \
+    zphaseshiftpatterndecoder.cpp \
+    zphaseshiftpatternimageprovider.cpp \
+    zphaseshiftpatternprojection.cpp \
+    zphaseshiftpatternprojectionplugin.cpp \
+
+RESOURCES    += \
+    resources.qrc
+
+
+
+###############################################################################
+# Core
+include($$PWD/../../../zcore/zcore.pri)
+
+###############################################################################
+# Structured light system
+include($$PWD/../../zstructuredlight.pri)
+
+###############################################################################
+# Camera acquisition
+include($$PWD/../../../zcameraacquisition/zcameraacquisition.pri)
+
+###############################################################################
+# OpenCV
+include($$PWD/../../../../3rdparty/opencv.pri)
@@ -0,0 +1,28 @@
+import QtQuick 2.5
+
+Rectangle {
+    id: root
+    width: 480
+    height: 320
+    color: "black"
+
+    Item {
+        anchors.fill: parent
+        opacity: config.intensity
+
+        // PHASE SHIFT PATTERNS
+        // every pattern is loaded once, only the current one is visible
+        Repeater {
+            model: config.patternImageCount
+
+            Image {
+                anchors.fill: parent
+                visible: index === config.currentPattern
+                fillMode: Image.Stretch
+                smooth: false
+                cache: false
+                source: "image://phaseshiftpattern/" + config.patternImagesVersion + "/" + index
+            }
+        }
+    }
+}
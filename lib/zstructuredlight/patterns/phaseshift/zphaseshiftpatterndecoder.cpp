@@ -0,0 +1,514 @@
+//
+// Z3D - A structured light 3D scanner
+// Copyright (C) 2013-2016 Nicolas Ulrich <nikolaseu@gmail.com>
+//
+// This file is part of Z3D.
+//
+// Z3D is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Z3D is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Z3D.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "zphaseshiftpatterndecoder.h"
+
+#include "zbinarypatterndecoder.h"
+#include "zdecodedpattern.h"
+#include "zsimdutils.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring> // memcpy
+
+#include <QDebug>
+
+namespace Z3D
+{
+
+namespace ZPhaseShiftPatternDecoder
+{
+
+namespace
+{
+
+/// maximum number of phase steps supported by the kernels
+constexpr int MAX_PHASE_STEPS = 32;
+
+/// parameters shared by every row
+struct PhaseParams
+{
+    int stepCount;
+    float cosTable[MAX_PHASE_STEPS];
+    float sinTable[MAX_PHASE_STEPS];
+    /// squared threshold for the (unscaled) modulation, S^2 + C^2
+    float minModulationSq;
+    float fringePeriod;
+    /// whether decodedRow has the half period index used to unwrap the phase
+    /// or only marks the valid pixels (anything but NO_VALUE)
+    bool unwrapHalfPeriods;
+};
+
+/// Computes the wrapped phase of the pixels [begin, end) of a row. When
+/// unwrapping with the half period index already stored in decodedRow it is
+/// replaced by the final projector coordinate, otherwise by the wrapped phase
+/// in cycles
+typedef void (*PhaseRowFunc)(const uint8_t * const *rows,
+                             const PhaseParams &params,
+                             float *decodedRow,
+                             int begin,
+                             int end);
+
+/// atan2 polynomial approximation (max error ~1e-5 rad), the same one is used
+/// by every kernel so results don't depend on the instruction set.
+/// Returns the angle in cycles, i.e. in (-0.5, 0.5]
+constexpr float ATAN_C1 = 0.99997726f;
+constexpr float ATAN_C3 = -0.33262347f;
+constexpr float ATAN_C5 = 0.19354346f;
+constexpr float ATAN_C7 = -0.11643287f;
+constexpr float ATAN_C9 = 0.05265332f;
+constexpr float ATAN_C11 = -0.01172120f;
+constexpr float HALF_PI = 1.57079632679f;
+constexpr float PI = 3.14159265359f;
+constexpr float INV_TWO_PI = 0.15915494309f;
+
+inline float atan2Cycles(float y, float x)
+{
+    const float ax = std::fabs(x);
+    const float ay = std::fabs(y);
+    const float a = std::min(ax, ay) / std::max(std::max(ax, ay), FLT_MIN);
+    const float s = a * a;
+    float r = ((((((ATAN_C11 * s + ATAN_C9) * s + ATAN_C7) * s + ATAN_C5) * s + ATAN_C3) * s) + ATAN_C1) * a;
+    if (ay > ax) {
+        r = HALF_PI - r;
+    }
+    if (x < 0.f) {
+        r = PI - r;
+    }
+    if (y < 0.f) {
+        r = -r;
+    }
+    return r * INV_TWO_PI;
+}
+
+/// the unwrapped phase is the wrapped phase plus the number of periods that
+/// brings it closest to the center of the half period given by the gray code
+inline float unwrap(float wrappedCycles, float halfPeriodIndex, float fringePeriod)
+{
+    const float coarseCycles = (halfPeriodIndex + 0.5f) * 0.5f;
+    const float periods = std::nearbyint(coarseCycles - wrappedCycles);
+    return (wrappedCycles + periods) * fringePeriod;
+}
+
+void phaseRowScalar(const uint8_t * const *rows, const PhaseParams &params, float *decodedRow, int begin, int end)
+{
+    for (int x=begin; x<end; ++x) {
+        const float halfPeriodIndex = decodedRow[x];
+        if (halfPeriodIndex == ZDecodedPattern::NO_VALUE) {
+            continue;
+        }
+
+        float s = 0.f;
+        float c = 0.f;
+        for (int k=0; k<params.stepCount; ++k) {
+            const float value = rows[k][x];
+            s += value * params.sinTable[k];
+            c += value * params.cosTable[k];
+        }
+
+        if (s * s + c * c < params.minModulationSq) {
+            decodedRow[x] = ZDecodedPattern::NO_VALUE;
+            continue;
+        }
+
+        const float wrapped = atan2Cycles(-s, c);
+        decodedRow[x] = params.unwrapHalfPeriods
+                ? unwrap(wrapped, halfPeriodIndex, params.fringePeriod)
+                : wrapped;
+    }
+}
+
+#if defined(Z3D_SIMD_X86)
+
+Z3D_TARGET_SSE41
+inline __m128 loadPixelsSSE41(const uint8_t *data)
+{
+    int32_t bytes;
+    memcpy(&bytes, data, sizeof(bytes));
+    return _mm_cvtepi32_ps(_mm_cvtepu8_epi32(_mm_cvtsi32_si128(bytes)));
+}
+
+Z3D_TARGET_SSE41
+inline __m128 atan2CyclesSSE41(__m128 y, __m128 x)
+{
+    const __m128 signMask = _mm_set1_ps(-0.f);
+    const __m128 ax = _mm_andnot_ps(signMask, x);
+    const __m128 ay = _mm_andnot_ps(signMask, y);
+    const __m128 a = _mm_div_ps(_mm_min_ps(ax, ay), _mm_max_ps(_mm_max_ps(ax, ay), _mm_set1_ps(FLT_MIN)));
+    const __m128 s = _mm_mul_ps(a, a);
+    __m128 r = _mm_set1_ps(ATAN_C11);
+    r = _mm_add_ps(_mm_mul_ps(r, s), _mm_set1_ps(ATAN_C9));
+    r = _mm_add_ps(_mm_mul_ps(r, s), _mm_set1_ps(ATAN_C7));
+    r = _mm_add_ps(_mm_mul_ps(r, s), _mm_set1_ps(ATAN_C5));
+    r = _mm_add_ps(_mm_mul_ps(r, s), _mm_set1_ps(ATAN_C3));
+    r = _mm_add_ps(_mm_mul_ps(r, s), _mm_set1_ps(ATAN_C1));
+    r = _mm_mul_ps(r, a);
+    r = _mm_blendv_ps(r, _mm_sub_ps(_mm_set1_ps(HALF_PI), r), _mm_cmpgt_ps(ay, ax));
+    r = _mm_blendv_ps(r, _mm_sub_ps(_mm_set1_ps(PI), r), _mm_cmplt_ps(x, _mm_setzero_ps()));
+    r = _mm_blendv_ps(r, _mm_xor_ps(r, signMask), _mm_cmplt_ps(y, _mm_setzero_ps()));
+    return _mm_mul_ps(r, _mm_set1_ps(INV_TWO_PI));
+}
+
+Z3D_TARGET_SSE41
+void phaseRowSSE41(const uint8_t * const *rows, const PhaseParams &params, float *decodedRow, int begin, int end)
+{
+    const __m128 noValue = _mm_set1_ps(ZDecodedPattern::NO_VALUE);
+    const __m128 minModulationSq = _mm_set1_ps(params.minModulationSq);
+    const __m128 fringePeriod = _mm_set1_ps(params.fringePeriod);
+
+    int x = begin;
+    for (; x+4<=end; x+=4) {
+        const __m128 halfPeriodIndex = _mm_loadu_ps(decodedRow + x);
+        const __m128 hasCode = _mm_cmpneq_ps(halfPeriodIndex, noValue);
+        if (!_mm_movemask_ps(hasCode)) {
+            continue;
+        }
+
+        __m128 s = _mm_setzero_ps();
+        __m128 c = _mm_setzero_ps();
+        for (int k=0; k<params.stepCount; ++k) {
+            const __m128 value = loadPixelsSSE41(rows[k] + x);
+            s = _mm_add_ps(s, _mm_mul_ps(value, _mm_set1_ps(params.sinTable[k])));
+            c = _mm_add_ps(c, _mm_mul_ps(value, _mm_set1_ps(params.cosTable[k])));
+        }
+
+        const __m128 modulationSq = _mm_add_ps(_mm_mul_ps(s, s), _mm_mul_ps(c, c));
+        const __m128 isValid = _mm_and_ps(hasCode, _mm_cmpge_ps(modulationSq, minModulationSq));
+
+        __m128 value = atan2CyclesSSE41(_mm_xor_ps(s, _mm_set1_ps(-0.f)), c);
+        if (params.unwrapHalfPeriods) {
+            const __m128 coarse = _mm_mul_ps(_mm_add_ps(halfPeriodIndex, _mm_set1_ps(0.5f)), _mm_set1_ps(0.5f));
+            const __m128 periods = _mm_round_ps(_mm_sub_ps(coarse, value), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+            value = _mm_mul_ps(_mm_add_ps(value, periods), fringePeriod);
+        }
+
+        _mm_storeu_ps(decodedRow + x, _mm_blendv_ps(noValue, value, isValid));
+    }
+
+    phaseRowScalar(rows, params, decodedRow, x, end);
+}
+
+Z3D_TARGET_AVX2
+inline __m256 loadPixelsAVX2(const uint8_t *data)
+{
+    return _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(data))));
+}
+
+Z3D_TARGET_AVX2
+inline __m256 atan2CyclesAVX2(__m256 y, __m256 x)
+{
+    const __m256 signMask = _mm256_set1_ps(-0.f);
+    const __m256 ax = _mm256_andnot_ps(signMask, x);
+    const __m256 ay = _mm256_andnot_ps(signMask, y);
+    const __m256 a = _mm256_div_ps(_mm256_min_ps(ax, ay), _mm256_max_ps(_mm256_max_ps(ax, ay), _mm256_set1_ps(FLT_MIN)));
+    const __m256 s = _mm256_mul_ps(a, a);
+    __m256 r = _mm256_set1_ps(ATAN_C11);
+    r = _mm256_add_ps(_mm256_mul_ps(r, s), _mm256_set1_ps(ATAN_C9));
+    r = _mm256_add_ps(_mm256_mul_ps(r, s), _mm256_set1_ps(ATAN_C7));
+    r = _mm256_add_ps(_mm256_mul_ps(r, s), _mm256_set1_ps(ATAN_C5));
+    r = _mm256_add_ps(_mm256_mul_ps(r, s), _mm256_set1_ps(ATAN_C3));
+    r = _mm256_add_ps(_mm256_mul_ps(r, s), _mm256_set1_ps(ATAN_C1));
+    r = _mm256_mul_ps(r, a);
+    r = _mm256_blendv_ps(r, _mm256_sub_ps(_mm256_set1_ps(HALF_PI), r), _mm256_cmp_ps(ay, ax, _CMP_GT_OQ));
+    r = _mm256_blendv_ps(r, _mm256_sub_ps(_mm256_set1_ps(PI), r), _mm256_cmp_ps(x, _mm256_setzero_ps(), _CMP_LT_OQ));
+    r = _mm256_blendv_ps(r, _mm256_xor_ps(r, signMask), _mm256_cmp_ps(y, _mm256_setzero_ps(), _CMP_LT_OQ));
+    return _mm256_mul_ps(r, _mm256_set1_ps(INV_TWO_PI));
+}
+
+Z3D_TARGET_AVX2
+void phaseRowAVX2(const uint8_t * const *rows, const PhaseParams &params, float *decodedRow, int begin, int end)
+{
+    const __m256 noValue = _mm256_set1_ps(ZDecodedPattern::NO_VALUE);
+    const __m256 minModulationSq = _mm256_set1_ps(params.minModulationSq);
+    const __m256 fringePeriod = _mm256_set1_ps(params.fringePeriod);
+
+    int x = begin;
+    for (; x+8<=end; x+=8) {
+        const __m256 halfPeriodIndex = _mm256_loadu_ps(decodedRow + x);
+        const __m256 hasCode = _mm256_cmp_ps(halfPeriodIndex, noValue, _CMP_NEQ_UQ);
+        if (!_mm256_movemask_ps(hasCode)) {
+            continue;
+        }
+
+        __m256 s = _mm256_setzero_ps();
+        __m256 c = _mm256_setzero_ps();
+        for (int k=0; k<params.stepCount; ++k) {
+            const __m256 value = loadPixelsAVX2(rows[k] + x);
+            s = _mm256_add_ps(s, _mm256_mul_ps(value, _mm256_set1_ps(params.sinTable[k])));
+            c = _mm256_add_ps(c, _mm256_mul_ps(value, _mm256_set1_ps(params.cosTable[k])));
+        }
+
+        const __m256 modulationSq = _mm256_add_ps(_mm256_mul_ps(s, s), _mm256_mul_ps(c, c));
+        const __m256 isValid = _mm256_and_ps(hasCode, _mm256_cmp_ps(modulationSq, minModulationSq, _CMP_GE_OQ));
+
+        __m256 value = atan2CyclesAVX2(_mm256_xor_ps(s, _mm256_set1_ps(-0.f)), c);
+        if (params.unwrapHalfPeriods) {
+            const __m256 coarse = _mm256_mul_ps(_mm256_add_ps(halfPeriodIndex, _mm256_set1_ps(0.5f)), _mm256_set1_ps(0.5f));
+            const __m256 periods = _mm256_round_ps(_mm256_sub_ps(coarse, value), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+            value = _mm256_mul_ps(_mm256_add_ps(value, periods), fringePeriod);
+        }
+
+        _mm256_storeu_ps(decodedRow + x, _mm256_blendv_ps(noValue, value, isValid));
+    }
+
+    phaseRowScalar(rows, params, decodedRow, x, end);
+}
+
+#endif // Z3D_SIMD_X86
+
+PhaseRowFunc phaseRowKernel()
+{
+    /// selected only once, the first time we decode something
+    static const PhaseRowFunc kernel = []() {
+        const auto level = SimdUtils::bestSupportedLevel();
+        qDebug() << "phase shift pattern decoder using" << SimdUtils::levelName(level) << "kernels";
+        switch (level) {
+#if defined(Z3D_SIMD_X86)
+        case SimdUtils::SimdAVX2:
+            return &phaseRowAVX2;
+        case SimdUtils::SimdSSE41:
+            return &phaseRowSSE41;
+#endif
+        default:
+            return &phaseRowScalar;
+        }
+    }();
+
+    return kernel;
+}
+
+PhaseParams phaseParams(int stepCount, float minModulation, float fringePeriod, bool unwrapHalfPeriods)
+{
+    PhaseParams params;
+    params.stepCount = stepCount;
+    for (int k=0; k<stepCount; ++k) {
+        const double shift = 2. * M_PI * k / stepCount;
+        params.cosTable[k] = float(std::cos(shift));
+        params.sinTable[k] = float(std::sin(shift));
+    }
+    /// B = 2/N * sqrt(S^2 + C^2)
+    const float minModulationUnscaled = 0.5f * minModulation * stepCount;
+    params.minModulationSq = minModulationUnscaled * minModulationUnscaled;
+    params.fringePeriod = fringePeriod;
+    params.unwrapHalfPeriods = unwrapHalfPeriods;
+    return params;
+}
+
+/// fractional part, in [0, 1)
+inline float fract(float value)
+{
+    return value - std::floor(value);
+}
+
+/// Combines the wrapped phases (in cycles) of every frequency into the
+/// projector coordinate. The beat of the finest frequency with each of the
+/// others has a longer period, the longest one covers the whole pattern so
+/// it's absolute, and each one is used to unwrap the next shorter one.
+/// Every pixel is independent of its neighbors.
+void heterodyneRow(const float * const *wrappedRows,
+                   const std::vector<float> &fringePeriods,
+                   const std::vector<float> &beatPeriods,
+                   float *decodedRow,
+                   int width)
+{
+    const size_t frequencyCount = fringePeriods.size();
+    const float *finestRow = wrappedRows[0];
+    const float *lastRow = wrappedRows[frequencyCount - 1];
+    const float topPeriod = beatPeriods[frequencyCount - 1];
+    /// the longest beat covers the pattern plus one fringe period on each
+    /// side, so noise at the borders doesn't wrap around
+    const float topOffset = fringePeriods[0];
+
+    for (int x=0; x<width; ++x) {
+        /// invalid pixels were propagated to the last frequency
+        if (lastRow[x] == ZDecodedPattern::NO_VALUE) {
+            decodedRow[x] = ZDecodedPattern::NO_VALUE;
+            continue;
+        }
+
+        const float finest = finestRow[x];
+
+        float coordinate = fract(finest - lastRow[x] + topOffset / topPeriod) * topPeriod - topOffset;
+        for (size_t j = frequencyCount - 2; j > 0; --j) {
+            const float beat = fract(finest - wrappedRows[j][x]);
+            coordinate = (beat + std::nearbyint(coordinate / beatPeriods[j] - beat)) * beatPeriods[j];
+        }
+
+        decodedRow[x] = (finest + std::nearbyint(coordinate / fringePeriods[0] - finest)) * fringePeriods[0];
+    }
+}
+
+/// rows [rowBegin, rowEnd) of every image
+std::vector<cv::Mat> rowRanges(const std::vector<cv::Mat> &images, int rowBegin, int rowEnd)
+{
+    std::vector<cv::Mat> ranges;
+    ranges.reserve(images.size());
+    for (const auto &image : images) {
+        ranges.push_back(image.rowRange(rowBegin, rowEnd));
+    }
+    return ranges;
+}
+
+} // anonymous namespace
+
+
+void decodePhaseShiftImageRows(const std::vector<cv::Mat> &phaseImages, const std::vector<cv::Mat> &grayImages, const std::vector<cv::Mat> &invGrayImages, cv::Mat maskImg, float fringePeriod, float minModulation, cv::Mat decodedImg, int rowBegin, int rowEnd, cv::Mat confidenceImg)
+{
+    if (decodedImg.type() == CV_16UC1) {
+        /// the phase is computed in floating point, only for these rows so
+        /// they are still in cache when converted to fixed point
+        cv::Mat bandImg(rowEnd - rowBegin, decodedImg.cols, CV_32FC1);
+        decodePhaseShiftImageRows(rowRanges(phaseImages, rowBegin, rowEnd),
+                                  rowRanges(grayImages, rowBegin, rowEnd),
+                                  rowRanges(invGrayImages, rowBegin, rowEnd),
+                                  maskImg.rowRange(rowBegin, rowEnd), fringePeriod, minModulation,
+                                  bandImg, 0, bandImg.rows,
+                                  confidenceImg.empty() ? cv::Mat() : confidenceImg.rowRange(rowBegin, rowEnd));
+        cv::Mat decodedRows = decodedImg.rowRange(rowBegin, rowEnd);
+        ZDecodedPattern::convertDecodedImage(bandImg, decodedRows, CV_16UC1);
+        return;
+    }
+
+    const int stepCount = int(phaseImages.size());
+    if (stepCount < 3 || stepCount > MAX_PHASE_STEPS) {
+        qWarning() << "invalid number of phase steps:" << stepCount;
+        decodedImg.rowRange(rowBegin, rowEnd).setTo(ZDecodedPattern::NO_VALUE);
+        return;
+    }
+
+    /// first the half period index, decoded in place
+    ZBinaryPatternDecoder::decodeBinaryPatternImageRows(grayImages, invGrayImages, maskImg, true, decodedImg, rowBegin, rowEnd, confidenceImg);
+
+    const PhaseParams params = phaseParams(stepCount, minModulation, fringePeriod, true);
+    const PhaseRowFunc phaseRow = phaseRowKernel();
+
+    /// then the phase, while the row of codes is still in cache
+    const int imgWidth = decodedImg.cols;
+    std::vector<const uint8_t*> rows(phaseImages.size());
+    for (int y=rowBegin; y<rowEnd; ++y) {
+        for (int k=0; k<stepCount; ++k) {
+            rows[size_t(k)] = phaseImages[size_t(k)].ptr<uint8_t>(y);
+        }
+
+        phaseRow(rows.data(), params, decodedImg.ptr<float>(y), 0, imgWidth);
+    }
+}
+
+
+void decodeHeterodyneImageRows(const std::vector<std::vector<cv::Mat> > &phaseImages, cv::Mat maskImg, const std::vector<float> &fringePeriods, float minModulation, cv::Mat decodedImg, int rowBegin, int rowEnd)
+{
+    if (decodedImg.type() == CV_16UC1) {
+        /// same as decodePhaseShiftImageRows, one band in floating point
+        std::vector<std::vector<cv::Mat> > bandImages;
+        for (const auto &images : phaseImages) {
+            bandImages.push_back(rowRanges(images, rowBegin, rowEnd));
+        }
+        cv::Mat bandImg(rowEnd - rowBegin, decodedImg.cols, CV_32FC1);
+        decodeHeterodyneImageRows(bandImages, maskImg.rowRange(rowBegin, rowEnd), fringePeriods, minModulation,
+                                  bandImg, 0, bandImg.rows);
+        cv::Mat decodedRows = decodedImg.rowRange(rowBegin, rowEnd);
+        ZDecodedPattern::convertDecodedImage(bandImg, decodedRows, CV_16UC1);
+        return;
+    }
+
+    const size_t frequencyCount = fringePeriods.size();
+    bool isValid = frequencyCount >= 3 && phaseImages.size() == frequencyCount;
+    for (size_t j=0; isValid && j<frequencyCount; ++j) {
+        const int stepCount = int(phaseImages[j].size());
+        isValid = stepCount >= 3 && stepCount <= MAX_PHASE_STEPS
+                && (j == 0 || fringePeriods[j] > fringePeriods[0]);
+    }
+    if (!isValid) {
+        qWarning() << "invalid heterodyne configuration, frequencies:" << frequencyCount;
+        decodedImg.rowRange(rowBegin, rowEnd).setTo(ZDecodedPattern::NO_VALUE);
+        return;
+    }
+
+    std::vector<PhaseParams> params;
+    params.reserve(frequencyCount);
+    /// beat period of the finest frequency with each of the others
+    std::vector<float> beatPeriods(frequencyCount, 0.f);
+    for (size_t j=0; j<frequencyCount; ++j) {
+        params.push_back(phaseParams(int(phaseImages[j].size()), minModulation, fringePeriods[j], false));
+        if (j > 0) {
+            beatPeriods[j] = 1.f / (1.f / fringePeriods[0] - 1.f / fringePeriods[j]);
+        }
+    }
+
+    const PhaseRowFunc phaseRow = phaseRowKernel();
+
+    /// wrapped phase of each frequency, the finest one goes directly in decodedImg
+    const int imgWidth = decodedImg.cols;
+    std::vector<float> wrappedBuffer(size_t(imgWidth) * (frequencyCount - 1));
+    std::vector<float*> wrappedRows(frequencyCount);
+    for (size_t j=1; j<frequencyCount; ++j) {
+        wrappedRows[j] = wrappedBuffer.data() + size_t(imgWidth) * (j - 1);
+    }
+
+    const uint8_t *rows[MAX_PHASE_STEPS];
+    for (int y=rowBegin; y<rowEnd; ++y) {
+        const uint8_t *maskRow = maskImg.ptr<uint8_t>(y);
+        float *decodedRow = decodedImg.ptr<float>(y);
+        for (int x=0; x<imgWidth; ++x) {
+            decodedRow[x] = maskRow[x] ? 0.f : ZDecodedPattern::NO_VALUE;
+        }
+        wrappedRows[0] = decodedRow;
+
+        /// every frequency starts with the invalid pixels of the previous one,
+        /// so the last one has all of them
+        for (size_t j=0; j<frequencyCount; ++j) {
+            if (j > 0) {
+                memcpy(wrappedRows[j], wrappedRows[j - 1], sizeof(float) * size_t(imgWidth));
+            }
+            const auto &images = phaseImages[j];
+            for (size_t k=0; k<images.size(); ++k) {
+                rows[k] = images[k].ptr<uint8_t>(y);
+            }
+            phaseRow(rows, params[j], wrappedRows[j], 0, imgWidth);
+        }
+
+        heterodyneRow(wrappedRows.data(), fringePeriods, beatPeriods, decodedRow, imgWidth);
+    }
+}
+
+
+cv::Mat decodeHeterodyneImages(const std::vector<std::vector<cv::Mat> > &phaseImages, cv::Mat maskImg, const std::vector<float> &fringePeriods, float minModulation)
+{
+    cv::Mat decodedImg(maskImg.size(), CV_32FC1);
+
+    decodeHeterodyneImageRows(phaseImages, maskImg, fringePeriods, minModulation, decodedImg, 0, decodedImg.rows);
+
+    return decodedImg;
+}
+
+
+cv::Mat decodePhaseShiftImages(const std::vector<cv::Mat> &phaseImages, const std::vector<cv::Mat> &grayImages, const std::vector<cv::Mat> &invGrayImages, cv::Mat maskImg, float fringePeriod, float minModulation)
+{
+    cv::Mat decodedImg(maskImg.size(), CV_32FC1);
+
+    decodePhaseShiftImageRows(phaseImages, grayImages, invGrayImages, maskImg, fringePeriod, minModulation, decodedImg, 0, decodedImg.rows);
+
+    return decodedImg;
+}
+
+} // namespace ZPhaseShiftPatternDecoder
+
+} // namespace Z3D
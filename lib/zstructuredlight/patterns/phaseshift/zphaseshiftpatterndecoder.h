@@ -0,0 +1,95 @@
+/* * Z3D - A structured light 3D scanner
+ * Copyright (C) 2013-2016 Nicolas Ulrich <nikolaseu@gmail.com>
+ *
+ * This file is part of Z3D.
+ *
+ * Z3D is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Z3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Z3D.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <opencv2/core/mat.hpp>
+
+#include <vector>
+
+namespace Z3D
+{
+
+namespace ZPhaseShiftPatternDecoder
+{
+
+/// Decodes N-step phase shifting combined with a gray code used to unwrap the phase.
+///
+/// phaseImages are the N phase shifted images, I_k = A + B cos(phi + 2 pi k / N).
+/// grayImages/invGrayImages are the gray code (and inverted) images of the half
+/// period index, most significant bit first. Half periods are used instead of
+/// full periods so the unwrapping tolerates the gray code being off by up to a
+/// quarter of a period, i.e. it doesn't break at the fringe borders.
+///
+/// The result is the projector coordinate (in projector pixels, sub-pixel) along
+/// the coding axis, or ZDecodedPattern::NO_VALUE outside the mask or where the
+/// modulation B is lower than minModulation.
+///
+/// Only rows [rowBegin, rowEnd) are decoded into decodedImg (CV_32FC1 or
+/// fixed point CV_16UC1, already allocated), different row ranges can be
+/// decoded concurrently.
+/// confidenceImg (CV_8UC1, already allocated, optional) gets the confidence of
+/// the gray code, see ZBinaryPatternDecoder::decodeBinaryPatternImageRows
+void decodePhaseShiftImageRows(const std::vector<cv::Mat> &phaseImages,
+                               const std::vector<cv::Mat> &grayImages,
+                               const std::vector<cv::Mat> &invGrayImages,
+                               cv::Mat maskImg,
+                               float fringePeriod,
+                               float minModulation,
+                               cv::Mat decodedImg,
+                               int rowBegin,
+                               int rowEnd,
+                               cv::Mat confidenceImg = cv::Mat());
+
+cv::Mat decodePhaseShiftImages(const std::vector<cv::Mat> &phaseImages,
+                               const std::vector<cv::Mat> &grayImages,
+                               const std::vector<cv::Mat> &invGrayImages,
+                               cv::Mat maskImg,
+                               float fringePeriod,
+                               float minModulation);
+
+/// Decodes N-step phase shifting of several frequencies, using the
+/// multi-frequency heterodyne method to unwrap the phase.
+///
+/// phaseImages has the N phase shifted images of each frequency and
+/// fringePeriods the period of each one, in projector pixels. The first one
+/// is the finest and gives the precision, the beat of it with each of the
+/// others must get longer with the index, and the last beat must cover the
+/// pattern plus one fringe period on each side.
+/// At least three frequencies are needed, see
+/// ZPhaseShiftPatternImageProvider::heterodynePeriods.
+///
+/// The result is the same as decodePhaseShiftImageRows, but each pixel is
+/// unwrapped using only its own values.
+void decodeHeterodyneImageRows(const std::vector<std::vector<cv::Mat> > &phaseImages,
+                               cv::Mat maskImg,
+                               const std::vector<float> &fringePeriods,
+                               float minModulation,
+                               cv::Mat decodedImg,
+                               int rowBegin,
+                               int rowEnd);
+
+cv::Mat decodeHeterodyneImages(const std::vector<std::vector<cv::Mat> > &phaseImages,
+                               cv::Mat maskImg,
+                               const std::vector<float> &fringePeriods,
+                               float minModulation);
+
+} // namespace ZPhaseShiftPatternDecoder
+
+} // namespace Z3D
@@ -0,0 +1,165 @@
+//
+// Z3D - A structured light 3D scanner
+// Copyright (C) 2013-2016 Nicolas Ulrich <nikolaseu@gmail.com>
+//
+// This file is part of Z3D.
+//
+// Z3D is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Z3D is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Z3D.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "zphaseshiftpatternimageprovider.h"
+
+#include <QDebug>
+#include <QMutexLocker>
+
+#include <cmath>
+#include <functional>
+
+namespace Z3D
+{
+
+ZPhaseShiftPatternImageProvider::ZPhaseShiftPatternImageProvider()
+    : QQuickImageProvider(QQuickImageProvider::Image)
+{
+
+}
+
+int ZPhaseShiftPatternImageProvider::grayCodeBits(int length, int fringePeriod)
+{
+    const int halfPeriodCount = int(std::ceil(2. * length / qMax(1, fringePeriod)));
+
+    int bits = 1;
+    while ((1 << bits) < halfPeriodCount) {
+        ++bits;
+    }
+
+    return bits;
+}
+
+std::vector<float> ZPhaseShiftPatternImageProvider::heterodynePeriods(int length, int fringePeriod, int frequencyCount)
+{
+    /// frequencies are in cycles per pattern length. The beat of the finest
+    /// frequency with frequency j is their difference, the last beat must be
+    /// a bit longer than the pattern (one more fringe period on each side)
+    const double finest = double(length) / qMax(1, fringePeriod);
+    const double lastBeat = double(length) / (length + 2. * fringePeriod);
+    const int steps = qMax(1, frequencyCount - 1);
+    const double ratio = std::pow(finest / lastBeat, 1. / steps);
+
+    std::vector<float> periods;
+    periods.reserve(size_t(qMax(1, frequencyCount)));
+    periods.push_back(float(fringePeriod));
+    for (int j = 1; j < frequencyCount; ++j) {
+        const double beat = lastBeat * std::pow(ratio, frequencyCount - 1 - j);
+        periods.push_back(float(length / (finest - beat)));
+    }
+
+    return periods;
+}
+
+void ZPhaseShiftPatternImageProvider::renderPatterns(const QSize &size, bool vertical, int phaseSteps, int fringePeriod, int frequencyCount)
+{
+    const int length = qMax(1, vertical ? size.width() : size.height());
+    const bool heterodyne = frequencyCount > 0;
+    const int bits = heterodyne ? 0 : grayCodeBits(length, fringePeriod);
+    const std::vector<float> periods = heterodyne
+            ? heterodynePeriods(length, fringePeriod, frequencyCount)
+            : std::vector<float>(1, float(fringePeriod));
+
+    std::vector<QImage> images;
+    images.reserve(size_t(2) + periods.size() * size_t(phaseSteps) + size_t(2 * bits));
+
+    /// renders one frame, valueAt returns the intensity for each coordinate
+    /// along the coding axis. When vertical the patterns are rotated like the
+    /// binary patterns, so the coordinate decreases from left to right
+    const auto render = [&](const std::function<int(int)> &valueAt) {
+        QImage image = vertical
+                ? QImage(length, 1, QImage::Format_RGB32)
+                : QImage(1, length, QImage::Format_RGB32);
+        for (int i = 0; i < length; ++i) {
+            const int value = valueAt(vertical ? length - 1 - i : i);
+            const QRgb color = qRgb(value, value, value);
+            if (vertical) {
+                image.setPixel(i, 0, color);
+            } else {
+                image.setPixel(0, i, color);
+            }
+        }
+        images.push_back(image);
+    };
+
+    /// white and black, used for the mask and the intensity image
+    render([](int) { return 255; });
+    render([](int) { return 0; });
+
+    /// phase shifted sinusoids, I_k = 0.5 + 0.5 cos(2 pi u / period + 2 pi k / N)
+    for (const float period : periods) {
+        for (int k = 0; k < phaseSteps; ++k) {
+            render([=](int u) {
+                const double phase = 2. * M_PI * (double(u) / double(period) + double(k) / phaseSteps);
+                return int(std::lround(127.5 * (1. + std::cos(phase))));
+            });
+        }
+    }
+
+    /// gray code of the half period index, most significant bit first
+    for (int bit = bits - 1; bit >= 0; --bit) {
+        for (int inverted = 0; inverted < 2; ++inverted) {
+            render([=](int u) {
+                const int halfPeriod = (2 * u) / fringePeriod;
+                const int grayCode = halfPeriod ^ (halfPeriod >> 1);
+                const bool white = ((grayCode >> bit) & 1) != inverted;
+                return white ? 255 : 0;
+            });
+        }
+    }
+
+    QMutexLocker locker(&m_mutex);
+    m_images.swap(images);
+}
+
+int ZPhaseShiftPatternImageProvider::imageCount()
+{
+    QMutexLocker locker(&m_mutex);
+    return int(m_images.size());
+}
+
+QImage ZPhaseShiftPatternImageProvider::requestImage(const QString &id, QSize *size, const QSize &requestedSize)
+{
+    Q_UNUSED(requestedSize)
+
+    QImage image;
+
+    bool ok = false;
+    const int index = id.section('/', -1).toInt(&ok);
+
+    {
+        QMutexLocker locker(&m_mutex);
+        if (ok && index >= 0 && size_t(index) < m_images.size()) {
+            image = m_images[size_t(index)];
+        }
+    }
+
+    if (image.isNull()) {
+        qWarning() << "invalid pattern image requested:" << id;
+    }
+
+    if (size) {
+        *size = image.size();
+    }
+
+    return image;
+}
+
+} // namespace Z3D
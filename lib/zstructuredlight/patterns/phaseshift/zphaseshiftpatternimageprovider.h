@@ -0,0 +1,66 @@
+/* * Z3D - A structured light 3D scanner
+ * Copyright (C) 2013-2016 Nicolas Ulrich <nikolaseu@gmail.com>
+ *
+ * This file is part of Z3D.
+ *
+ * Z3D is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Z3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Z3D.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <QMutex>
+#include <QQuickImageProvider>
+
+#include <vector>
+
+namespace Z3D
+{
+
+/// Pre-rendered phase shift patterns for the projection window.
+/// The sequence is: all white, all black, the phase shifted sinusoids and the
+/// gray code (normal and inverted) of the half period index, see
+/// ZPhaseShiftPatternDecoder. When using heterodyne unwrapping there is no gray
+/// code, instead the phase shifted sinusoids are repeated for each frequency.
+/// Every frame is rendered once as a single row (vertical patterns) or column
+/// (horizontal patterns) that is stretched to fill the window.
+/// Images are requested as "<version>/<index>", version is only used to force
+/// QML to reload them.
+class ZPhaseShiftPatternImageProvider : public QQuickImageProvider
+{
+public:
+    explicit ZPhaseShiftPatternImageProvider();
+
+    /// number of gray code bits needed to encode every half period
+    static int grayCodeBits(int length, int fringePeriod);
+
+    /// fringe periods used for heterodyne unwrapping, the first one is
+    /// fringePeriod and the rest are chosen so every unwrapping step
+    /// multiplies the period by the same ratio
+    static std::vector<float> heterodynePeriods(int length, int fringePeriod, int frequencyCount);
+
+    /// render all the frames for the given projection size, frequencyCount
+    /// is the number of heterodyne frequencies or 0 to use the gray code
+    void renderPatterns(const QSize &size, bool vertical, int phaseSteps, int fringePeriod, int frequencyCount = 0);
+
+    int imageCount();
+
+    // QQuickImageProvider interface
+    virtual QImage requestImage(const QString &id, QSize *size, const QSize &requestedSize) override;
+
+private:
+    QMutex m_mutex;
+    std::vector<QImage> m_images;
+};
+
+} // namespace Z3D
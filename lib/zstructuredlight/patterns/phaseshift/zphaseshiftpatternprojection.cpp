@@ -0,0 +1,806 @@
+//
+// Z3D - A structured light 3D scanner
+// Copyright (C) 2013-2016 Nicolas Ulrich <nikolaseu@gmail.com>
+//
+// This file is part of Z3D.
+//
+// Z3D is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Z3D is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Z3D.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "zphaseshiftpatternprojection.h"
+
+#include "zbinarypatterndecoder.h"
+#include "zcameraimage.h"
+#include "zdecodedpattern.h"
+#include "zphaseshiftpatterndecoder.h"
+#include "zphaseshiftpatternimageprovider.h"
+#include "zprojectedpattern.h"
+
+#include "zparallelutils.h"
+#include "zprojectionutils.h"
+#include "zsettingsitem.h"
+
+#include <opencv2/core.hpp> // repeat
+#include <opencv2/imgcodecs.hpp>
+
+#include <QDateTime>
+#include <QDebug>
+#include <QGuiApplication>
+#include <QQmlContext>
+#include <QQmlEngine>
+#include <QQuickView>
+#include <QScreen>
+#include <QThread>
+
+
+namespace Z3D
+{
+
+ZPhaseShiftPatternProjection::ZPhaseShiftPatternProjection(QObject *parent)
+    : ZPatternProjection(parent)
+    , m_dlpview(nullptr)
+    , m_imageProvider(new ZPhaseShiftPatternImageProvider())
+    , m_patternImagesVersion(0)
+    , m_delayMs(500)
+    , m_settleFrames(2)
+    , m_noiseThreshold(15)
+    , m_minModulation(10)
+    , m_phaseSteps(4)
+    , m_fringePeriod(32)
+    , m_heterodyne(false)
+    , m_frequencyCount(3)
+    , m_intensity(1.)
+    , m_currentPattern(0)
+    , m_vertical(true)
+    , m_decodeThreads(0)
+    , m_debugMode(false)
+    , m_previewEnabled(false)
+    , m_scanPhaseSteps(0)
+    , m_scanFringePeriod(0)
+    , m_scanGrayCodeBits(0)
+    , m_scanLength(0)
+    , m_projectorDecodedImageId(0)
+{
+    m_dlpview = new QQuickView();
+    m_dlpview->setFlags(Qt::FramelessWindowHint
+                        | Qt::WindowTransparentForInput
+                        | Qt::WindowDoesNotAcceptFocus
+                        );
+    m_dlpview->rootContext()->setContextProperty("config", this);
+    /// the engine takes ownership of the image provider
+    m_dlpview->engine()->addImageProvider("phaseshiftpattern", m_imageProvider);
+    updatePatternImages();
+    m_dlpview->setSource(QUrl("qrc:///zstructuredlight/qml/phaseshiftpatternprojection.qml"));
+    m_dlpview->setResizeMode(QQuickView::SizeRootObjectToView);
+
+    const QString projectorScreen("Projector screen");
+
+    std::shared_ptr<ZSettingsItemEnum> screenOption = std::unique_ptr<ZSettingsItemEnum>(new ZSettingsItemEnum(projectorScreen, "Projector", "Screen/projector to use",
+                                                                                             [=](){
+        std::vector<QString> screens;
+        for (const auto *screen : qGuiApp->screens()) {
+            const auto size = screen->size();
+            screens.push_back(QString("%2x%3 [%1]").arg(screen->name()).arg(size.width()).arg(size.height()));
+        }
+        return screens;
+    },
+                                                                        [=](){ return selectedScreen(); },
+    std::bind(&ZPhaseShiftPatternProjection::setSelectedScreen, this, std::placeholders::_1)));
+    QObject::connect(qGuiApp, &QGuiApplication::screenAdded,
+                     screenOption.get(), &ZSettingsItemEnum::optionsChanged);
+    QObject::connect(qGuiApp, &QGuiApplication::screenRemoved,
+                     screenOption.get(), &ZSettingsItemEnum::optionsChanged);
+
+    const QString preview("Preview");
+
+    ZSettingsItemPtr previewOption = std::make_unique<ZSettingsItemBool>(preview, "Show preview", "Show preview",
+                                                                         std::bind(&ZPhaseShiftPatternProjection::previewEnabled, this),
+                                                                         std::bind(&ZPhaseShiftPatternProjection::setPreviewEnabled, this, std::placeholders::_1));
+    QObject::connect(this, &ZPhaseShiftPatternProjection::previewEnabledChanged,
+                     previewOption.get(), &ZSettingsItem::valueChanged);
+
+    ZSettingsItemPtr currentPatternOption = std::make_unique<ZSettingsItemInt>(preview, "Current pattern", "Frame of the sequence being displayed",
+                                                                               std::bind(&ZPhaseShiftPatternProjection::currentPattern, this),
+                                                                               std::bind(&ZPhaseShiftPatternProjection::setCurrentPattern, this, std::placeholders::_1),
+                                                                               0, // minimum
+                                                                               64); // maximum
+    QObject::connect(this, &ZPhaseShiftPatternProjection::currentPatternChanged,
+                     currentPatternOption.get(), &ZSettingsItem::valueChanged);
+    QObject::connect(this, &ZPhaseShiftPatternProjection::previewEnabledChanged,
+                     currentPatternOption.get(), &ZSettingsItem::setWritable);
+    currentPatternOption->setWritable(previewEnabled());
+
+    const QString scanConfiguration("Scan configuration");
+
+    ZSettingsItemPtr useVerticalPatternOption = std::make_unique<ZSettingsItemBool>(scanConfiguration, "Vertical patterns", "Use vertical patterns (for example if the projector is rotated or cameras are arranged vertically)",
+                                                                                    std::bind(&ZPhaseShiftPatternProjection::vertical, this),
+                                                                                    std::bind(&ZPhaseShiftPatternProjection::setVertical, this, std::placeholders::_1));
+    QObject::connect(this, &ZPhaseShiftPatternProjection::verticalChanged,
+                     useVerticalPatternOption.get(), &ZSettingsItem::valueChanged);
+
+    ZSettingsItemPtr phaseStepsOption = std::make_unique<ZSettingsItemInt>(scanConfiguration, "Phase steps", "Number of phase shifted patterns, more steps are less sensitive to noise",
+                                                                           std::bind(&ZPhaseShiftPatternProjection::phaseSteps, this),
+                                                                           std::bind(&ZPhaseShiftPatternProjection::setPhaseSteps, this, std::placeholders::_1),
+                                                                           3, // minimum
+                                                                           16); // maximum
+    QObject::connect(this, &ZPhaseShiftPatternProjection::phaseStepsChanged,
+                     phaseStepsOption.get(), &ZSettingsItem::valueChanged);
+
+    ZSettingsItemPtr fringePeriodOption = std::make_unique<ZSettingsItemInt>(scanConfiguration, "Fringe period", "Period of the sinusoidal patterns (in projector pixels)",
+                                                                             std::bind(&ZPhaseShiftPatternProjection::fringePeriod, this),
+                                                                             std::bind(&ZPhaseShiftPatternProjection::setFringePeriod, this, std::placeholders::_1),
+                                                                             8, // minimum
+                                                                             1024); // maximum
+    QObject::connect(this, &ZPhaseShiftPatternProjection::fringePeriodChanged,
+                     fringePeriodOption.get(), &ZSettingsItem::valueChanged);
+
+    ZSettingsItemPtr heterodyneOption = std::make_unique<ZSettingsItemBool>(scanConfiguration, "Heterodyne unwrapping", "Unwrap the phase using several fringe frequencies instead of the gray code. Each pixel is decoded independently, using less frames",
+                                                                            std::bind(&ZPhaseShiftPatternProjection::heterodyne, this),
+                                                                            std::bind(&ZPhaseShiftPatternProjection::setHeterodyne, this, std::placeholders::_1));
+    QObject::connect(this, &ZPhaseShiftPatternProjection::heterodyneChanged,
+                     heterodyneOption.get(), &ZSettingsItem::valueChanged);
+
+    ZSettingsItemPtr frequencyCountOption = std::make_unique<ZSettingsItemInt>(scanConfiguration, "Frequencies", "Number of fringe frequencies used for heterodyne unwrapping, more frequencies are less sensitive to noise",
+                                                                               std::bind(&ZPhaseShiftPatternProjection::frequencyCount, this),
+                                                                               std::bind(&ZPhaseShiftPatternProjection::setFrequencyCount, this, std::placeholders::_1),
+                                                                               3, // minimum
+                                                                               8); // maximum
+    QObject::connect(this, &ZPhaseShiftPatternProjection::frequencyCountChanged,
+                     frequencyCountOption.get(), &ZSettingsItem::valueChanged);
+    QObject::connect(this, &ZPhaseShiftPatternProjection::heterodyneChanged,
+                     frequencyCountOption.get(), &ZSettingsItem::setWritable);
+    frequencyCountOption->setWritable(heterodyne());
+
+    const QString advancedSettings("Advanced settings");
+
+    ZSettingsItemPtr delayOption = std::make_unique<ZSettingsItemInt>(advancedSettings, "Delay", "Maximum time to wait for each pattern to be displayed (in ms)",
+                                                                      std::bind(&ZPhaseShiftPatternProjection::delayMs, this),
+                                                                      std::bind(&ZPhaseShiftPatternProjection::setDelayMs, this, std::placeholders::_1),
+                                                                      0, // minimum
+                                                                      10000); // maximum
+    QObject::connect(this, &ZPhaseShiftPatternProjection::delayMsChanged,
+                     delayOption.get(), &ZSettingsItem::valueChanged);
+
+    ZSettingsItemPtr settleFramesOption = std::make_unique<ZSettingsItemInt>(advancedSettings, "Settle frames", "Display refresh periods to wait after the pattern is displayed, to account for projector latency",
+                                                                             std::bind(&ZPhaseShiftPatternProjection::settleFrames, this),
+                                                                             std::bind(&ZPhaseShiftPatternProjection::setSettleFrames, this, std::placeholders::_1),
+                                                                             0, // minimum
+                                                                             60); // maximum
+    QObject::connect(this, &ZPhaseShiftPatternProjection::settleFramesChanged,
+                     settleFramesOption.get(), &ZSettingsItem::valueChanged);
+
+    ZSettingsItemPtr noiseThresholdOption = std::make_unique<ZSettingsItemInt>(advancedSettings, "Noise threshold", "Discard pixels where the difference between the white and black images is not greater than threshold value",
+                                                                               std::bind(&ZPhaseShiftPatternProjection::noiseThreshold, this),
+                                                                               std::bind(&ZPhaseShiftPatternProjection::setNoiseThreshold, this, std::placeholders::_1),
+                                                                               0, // minimum
+                                                                               255); // maximum
+    QObject::connect(this, &ZPhaseShiftPatternProjection::noiseThresholdChanged,
+                     noiseThresholdOption.get(), &ZSettingsItem::valueChanged);
+
+    ZSettingsItemPtr minModulationOption = std::make_unique<ZSettingsItemInt>(advancedSettings, "Modulation threshold", "Discard pixels where the amplitude of the sinusoid is lower than threshold value",
+                                                                              std::bind(&ZPhaseShiftPatternProjection::minModulation, this),
+                                                                              std::bind(&ZPhaseShiftPatternProjection::setMinModulation, this, std::placeholders::_1),
+                                                                              0, // minimum
+                                                                              127); // maximum
+    QObject::connect(this, &ZPhaseShiftPatternProjection::minModulationChanged,
+                     minModulationOption.get(), &ZSettingsItem::valueChanged);
+
+    ZSettingsItemPtr intensityOption = std::make_unique<ZSettingsItemFloat>(advancedSettings, "Intensity", "Intensity of projected pattern",
+                                                                            std::bind(&ZPhaseShiftPatternProjection::intensity, this),
+                                                                            std::bind(&ZPhaseShiftPatternProjection::setIntensity, this, std::placeholders::_1),
+                                                                            0.0, // minimum
+                                                                            1.0); // maximum
+    QObject::connect(this, &ZPhaseShiftPatternProjection::intensityChanged,
+                     intensityOption.get(), &ZSettingsItem::valueChanged);
+
+    ZSettingsItemPtr decodeThreadsOption = std::make_unique<ZSettingsItemInt>(advancedSettings, "Decode threads", "Number of threads used to decode the patterns (0 = one per core)",
+                                                                              std::bind(&ZPhaseShiftPatternProjection::decodeThreads, this),
+                                                                              std::bind(&ZPhaseShiftPatternProjection::setDecodeThreads, this, std::placeholders::_1),
+                                                                              0, // minimum
+                                                                              64); // maximum
+    QObject::connect(this, &ZPhaseShiftPatternProjection::decodeThreadsChanged,
+                     decodeThreadsOption.get(), &ZSettingsItem::valueChanged);
+
+    ZSettingsItemPtr saveDebugInfoOption = std::make_unique<ZSettingsItemBool>(advancedSettings, "Save debug info", "Save extra information for debugging purposes",
+                                                                               std::bind(&ZPhaseShiftPatternProjection::debugMode, this),
+                                                                               std::bind(&ZPhaseShiftPatternProjection::setDebugMode, this, std::placeholders::_1));
+    QObject::connect(this, &ZPhaseShiftPatternProjection::debugModeChanged,
+                     saveDebugInfoOption.get(), &ZSettingsItem::valueChanged);
+
+    m_settings = {
+        screenOption,
+        previewOption,
+        currentPatternOption,
+        useVerticalPatternOption,
+        phaseStepsOption,
+        fringePeriodOption,
+        heterodyneOption,
+        frequencyCountOption,
+        delayOption,
+        settleFramesOption,
+        noiseThresholdOption,
+        minModulationOption,
+        intensityOption,
+        decodeThreadsOption,
+        saveDebugInfoOption
+    };
+}
+
+ZPhaseShiftPatternProjection::~ZPhaseShiftPatternProjection()
+{
+    qDebug() << "deleting projector window...";
+    if (m_dlpview) {
+        m_dlpview->deleteLater();
+    }
+}
+
+const std::vector<ZSettingsItemPtr> &ZPhaseShiftPatternProjection::settings()
+{
+    return m_settings;
+}
+
+void ZPhaseShiftPatternProjection::showProjectionWindow()
+{
+    m_dlpview->show();
+}
+
+void ZPhaseShiftPatternProjection::hideProjectionWindow()
+{
+    m_dlpview->hide();
+}
+
+void ZPhaseShiftPatternProjection::setProjectionWindowGeometry(const QRect &geometry)
+{
+    m_dlpview->setGeometry(geometry);
+
+    updatePatternImages();
+}
+
+void ZPhaseShiftPatternProjection::beginScan()
+{
+    bool previewWasEnabled = setPreviewEnabled(true);
+
+    /// keep the parameters used to project the patterns, needed to decode them
+    const auto geometry = m_dlpview->geometry();
+    const int length = m_vertical ? geometry.width() : geometry.height();
+    m_scanPhaseSteps = m_phaseSteps;
+    m_scanFringePeriod = m_fringePeriod;
+    m_scanLength = length;
+    if (m_heterodyne) {
+        m_scanGrayCodeBits = 0;
+        m_scanFringePeriods = ZPhaseShiftPatternImageProvider::heterodynePeriods(length, m_fringePeriod, m_frequencyCount);
+    } else {
+        m_scanGrayCodeBits = ZPhaseShiftPatternImageProvider::grayCodeBits(length, m_fringePeriod);
+        m_scanFringePeriods.clear();
+    }
+    const int phaseFrameCount = m_scanPhaseSteps * qMax(1, int(m_scanFringePeriods.size()));
+
+    const int frameCount = patternImageCount();
+    qDebug() << "phase steps:" << m_scanPhaseSteps << "fringe period:" << m_scanFringePeriod
+             << "gray code bits:" << m_scanGrayCodeBits << "heterodyne frequencies:" << m_scanFringePeriods.size()
+             << "frames:" << frameCount;
+
+    QString scanTmpFolder = QString("tmp/dlpscans/%1").arg(QDateTime::currentDateTime().toString("yyyy.MM.dd_hh.mm.ss"));
+
+    emit prepareAcquisition(scanTmpFolder, 0);
+
+    /// acquisition time
+    QTime acquisitionTime;
+    acquisitionTime.start();
+
+    for (int iFrame=0; iFrame<frameCount; ++iFrame) {
+        setCurrentPattern(iFrame);
+
+        /// wait until the pattern is on screen and give the projector
+        /// some time to actually display it
+        if (!ProjectionUtils::waitForProjectedFrame(m_dlpview, m_delayMs)) {
+            qWarning() << "timeout waiting for pattern" << iFrame << "to be displayed";
+        }
+
+        QThread::msleep(ulong(ProjectionUtils::settleTimeMs(m_dlpview, m_settleFrames)));
+
+        QString fileName;
+        if (iFrame < 2) {
+            fileName = iFrame ? "black.png" : "white.png";
+        } else if (iFrame < 2 + phaseFrameCount) {
+            const int phaseFrame = iFrame - 2;
+            if (m_scanFringePeriods.empty()) {
+                fileName = QString("phase_%1.png").arg(phaseFrame, 2, 10, QLatin1Char('0'));
+            } else {
+                fileName = QString("phase_f%1_%2.png")
+                        .arg(phaseFrame / m_scanPhaseSteps)
+                        .arg(phaseFrame % m_scanPhaseSteps, 2, 10, QLatin1Char('0'));
+            }
+        } else {
+            const int grayFrame = iFrame - 2 - phaseFrameCount;
+            fileName = QString("gray_%1%2.png")
+                    .arg(grayFrame / 2, 2, 10, QLatin1Char('0'))
+                    .arg(grayFrame % 2 ? "_inv" : "");
+        }
+
+        emit acquireSingle(fileName);
+    }
+
+    qDebug() << "acquisition finished in" << acquisitionTime.elapsed() << "msecs";
+
+    emit finishAcquisition();
+
+    /// create the pattern that was just projected, one fringe per period
+    const int fringeLength = m_vertical ? geometry.height() : geometry.width();
+    std::vector<size_t> pointsPerCode(size_t(qMax(0, length)), 0);
+    for (int u = 0; u < length; u += m_scanFringePeriod) {
+        pointsPerCode[size_t(u)] = size_t(fringeLength);
+    }
+
+    ZFringePoints fringePoints;
+    fringePoints.allocate(pointsPerCode);
+    for (int u = 0; u < length; u += m_scanFringePeriod) {
+        /// vertical patterns are rotated, u decreases from left to right
+        const float x = float(length - 1 - u);
+        for (int i = 0; i<fringeLength; ++i) {
+            fringePoints.addPoint(u, m_vertical
+                                  ? cv::Vec2f(x, i)
+                                  : cv::Vec2f(i, u));
+        }
+    }
+    qDebug() << "pattern has" << fringePoints.fringeCount() << "fringes";
+
+    const Z3D::ZProjectedPatternPtr pattern(new Z3D::ZProjectedPattern(projectorDecodedImage(), std::move(fringePoints), m_projectorDecodedImageId));
+
+    /// notify possible listeners
+    emit patternProjected(pattern);
+
+    /// return previous state
+    setPreviewEnabled(previewWasEnabled);
+}
+
+cv::Mat ZPhaseShiftPatternProjection::projectorDecodedImage()
+{
+    const QSize size = m_dlpview->geometry().size();
+    const QString key = QString("%1x%2 vertical:%3").arg(size.width()).arg(size.height()).arg(m_vertical);
+    if (key == m_projectorDecodedImageKey) {
+        return m_projectorDecodedImage;
+    }
+
+    /// the decoded value is the projector coordinate along the coding axis,
+    /// that decreases from left to right when vertical (see renderPatterns)
+    const int length = qMax(1, m_vertical ? size.width() : size.height());
+    cv::Mat decodedLine(1, length, CV_32FC1);
+    for (int i = 0; i < length; ++i) {
+        decodedLine.at<float>(0, i) = float(m_vertical ? length - 1 - i : i);
+    }
+
+    /// always in a new image, the previous one is shared with the patterns
+    /// already projected and cv::repeat would reuse its buffer
+    cv::Mat projectorDecodedImage;
+    if (m_vertical) {
+        cv::repeat(decodedLine, size.height(), 1, projectorDecodedImage);
+    } else {
+        cv::repeat(decodedLine.t(), 1, size.width(), projectorDecodedImage);
+    }
+    m_projectorDecodedImage = projectorDecodedImage;
+    m_projectorDecodedImageKey = key;
+    m_projectorDecodedImageId = ZProjectedPattern::newDecodedImageId();
+
+    return m_projectorDecodedImage;
+}
+
+void ZPhaseShiftPatternProjection::processImages(std::vector<std::vector<ZCameraImagePtr> > acquiredImages, QString scanId)
+{
+    /// acquiredImages indexing
+    ///     1st index: image number / order
+    ///     2nd index: camera index
+    const size_t numImages = acquiredImages.size();
+    const size_t frequencyCount = size_t(qMax(1, int(m_scanFringePeriods.size())));
+    const size_t expectedImages = 2 + frequencyCount * size_t(m_scanPhaseSteps) + size_t(2 * m_scanGrayCodeBits);
+    if (numImages != expectedImages) {
+        qWarning() << "invalid number of images, expected" << expectedImages << "got" << numImages;
+        return;
+    }
+
+    const size_t numCameras = acquiredImages.front().size();
+
+    /// decodification time
+    QTime decodeTime;
+    decodeTime.start();
+
+    std::vector<cv::Mat> maskImages(numCameras);
+    std::vector<cv::Mat> intensityImages(numCameras);
+    std::vector<cv::Mat> decodedImages(numCameras);
+    std::vector<cv::Mat> confidenceImages(numCameras);
+    std::vector<cv::Rect> roiRects(numCameras);
+    /// phase images of each camera, for every frequency
+    std::vector< std::vector< std::vector<cv::Mat> > > phaseImages(numCameras, std::vector< std::vector<cv::Mat> >(frequencyCount));
+    std::vector< std::vector<cv::Mat> > grayImages(numCameras);
+    std::vector< std::vector<cv::Mat> > invGrayImages(numCameras);
+    std::vector<int> imageRows(numCameras);
+    /// the unwrapped phase goes from 0 to the projected length in pixels
+    const int decodedType = decodedImageType(m_scanLength - 1);
+
+    for (size_t iCam=0; iCam<numCameras; ++iCam) {
+        for (size_t iImage=0; iImage<numImages; ++iImage) {
+            if (!acquiredImages[iImage][iCam]) {
+                qWarning() << "missing image" << iImage << "for camera" << iCam;
+                return;
+            }
+        }
+
+        /// the first images are the all white, all black
+        /// they are used to create the mask of valid pixels
+        const cv::Mat whiteImg = acquiredImages[0][iCam]->cvMat();
+        const cv::Mat blackImg = acquiredImages[1][iCam]->cvMat();
+
+        /// only the region of interest is decoded
+        cv::Rect &roi = roiRects[iCam];
+        roi = this->roi();
+        maskImages[iCam] = ZBinaryPatternDecoder::referenceMaskImage(whiteImg, blackImg, m_noiseThreshold, roi, autoRoi());
+
+        /// the gray code gives its own confidence, without it the contrast
+        /// between the white and black images is used (0 outside the mask)
+        confidenceImages[iCam] = cv::Mat(whiteImg.size(), CV_8UC1, cv::Scalar(0));
+        if (!m_scanFringePeriods.empty() && !roi.empty()) {
+            cv::Mat(whiteImg(roi) - blackImg(roi)).copyTo(confidenceImages[iCam](roi), maskImages[iCam]);
+        }
+
+        intensityImages[iCam] = whiteImg.clone();
+
+        size_t iImage = 2;
+        for (size_t iFreq=0; iFreq<frequencyCount; ++iFreq) {
+            for (int k=0; k<m_scanPhaseSteps; ++k, ++iImage) {
+                phaseImages[iCam][iFreq].push_back(acquiredImages[iImage][iCam]->cvMat()(roi));
+            }
+        }
+        for (int bit=0; bit<m_scanGrayCodeBits; ++bit, iImage+=2) {
+            grayImages[iCam].push_back(acquiredImages[iImage][iCam]->cvMat()(roi));
+            invGrayImages[iCam].push_back(acquiredImages[iImage+1][iCam]->cvMat()(roi));
+        }
+
+        decodedImages[iCam] = cv::Mat(whiteImg.size(), decodedType);
+        if (roi.size() != whiteImg.size()) {
+            decodedImages[iCam].setTo(Z3D::ZDecodedPattern::noValue(decodedType));
+        }
+        imageRows[iCam] = roi.height;
+    }
+
+    /// All the cameras are decoded at the same time, by bands of rows
+    const float fringePeriod = float(m_scanFringePeriod);
+    const float minModulation = float(m_minModulation);
+    ParallelUtils::forEachRowBand(imageRows, [&](int iCam, int rowBegin, int rowEnd) {
+        const size_t cam = size_t(iCam);
+        const cv::Rect &roi = roiRects[cam];
+        if (m_scanFringePeriods.empty()) {
+            ZPhaseShiftPatternDecoder::decodePhaseShiftImageRows(phaseImages[cam][0], grayImages[cam], invGrayImages[cam], maskImages[cam],
+                                                                 fringePeriod, minModulation,
+                                                                 decodedImages[cam](roi), rowBegin, rowEnd,
+                                                                 confidenceImages[cam](roi));
+        } else {
+            ZPhaseShiftPatternDecoder::decodeHeterodyneImageRows(phaseImages[cam], maskImages[cam],
+                                                                 m_scanFringePeriods, minModulation,
+                                                                 decodedImages[cam](roi), rowBegin, rowEnd);
+        }
+    }, m_decodeThreads);
+
+    std::vector<Z3D::ZDecodedPatternPtr> decodedPatternList;
+    for (size_t iCam=0; iCam<numCameras; ++iCam) {
+        Z3D::ZDecodedPatternPtr decodedPattern(new Z3D::ZDecodedPattern(decodedImages[iCam], intensityImages[iCam], confidenceImages[iCam], roiRects[iCam]));
+        decodedPatternList.push_back(decodedPattern);
+
+        if (m_debugMode) {
+            cv::imwrite(qPrintable(QString("%1/decoded_%2.tiff")
+                                   .arg(scanId)
+                                   .arg(iCam)),
+                        decodedImages[iCam]);
+        }
+    }
+
+    qDebug() << "pattern decodification finished in" << decodeTime.elapsed() << "msecs";
+
+    /// notify result
+    emit patternsDecoded(decodedPatternList);
+}
+
+int ZPhaseShiftPatternProjection::delayMs() const
+{
+    return m_delayMs;
+}
+
+bool ZPhaseShiftPatternProjection::setDelayMs(int arg)
+{
+    if (m_delayMs == arg) {
+        return true;
+    }
+
+    m_delayMs = arg;
+    emit delayMsChanged(arg);
+
+    return true;
+}
+
+int ZPhaseShiftPatternProjection::settleFrames() const
+{
+    return m_settleFrames;
+}
+
+bool ZPhaseShiftPatternProjection::setSettleFrames(int arg)
+{
+    if (m_settleFrames == arg) {
+        return true;
+    }
+
+    m_settleFrames = arg;
+    emit settleFramesChanged(arg);
+
+    return true;
+}
+
+int ZPhaseShiftPatternProjection::noiseThreshold() const
+{
+    return m_noiseThreshold;
+}
+
+bool ZPhaseShiftPatternProjection::setNoiseThreshold(int arg)
+{
+    if (m_noiseThreshold == arg) {
+        return true;
+    }
+
+    m_noiseThreshold = arg;
+    emit noiseThresholdChanged(arg);
+
+    return true;
+}
+
+int ZPhaseShiftPatternProjection::minModulation() const
+{
+    return m_minModulation;
+}
+
+bool ZPhaseShiftPatternProjection::setMinModulation(int arg)
+{
+    if (m_minModulation == arg) {
+        return true;
+    }
+
+    m_minModulation = arg;
+    emit minModulationChanged(arg);
+
+    return true;
+}
+
+int ZPhaseShiftPatternProjection::phaseSteps() const
+{
+    return m_phaseSteps;
+}
+
+bool ZPhaseShiftPatternProjection::setPhaseSteps(int arg)
+{
+    if (m_phaseSteps == arg) {
+        return true;
+    }
+
+    m_phaseSteps = arg;
+    emit phaseStepsChanged(arg);
+    updatePatternImages();
+
+    return true;
+}
+
+int ZPhaseShiftPatternProjection::fringePeriod() const
+{
+    return m_fringePeriod;
+}
+
+bool ZPhaseShiftPatternProjection::setFringePeriod(int arg)
+{
+    if (m_fringePeriod == arg) {
+        return true;
+    }
+
+    m_fringePeriod = arg;
+    emit fringePeriodChanged(arg);
+    updatePatternImages();
+
+    return true;
+}
+
+bool ZPhaseShiftPatternProjection::heterodyne() const
+{
+    return m_heterodyne;
+}
+
+bool ZPhaseShiftPatternProjection::setHeterodyne(bool arg)
+{
+    if (m_heterodyne == arg) {
+        return true;
+    }
+
+    m_heterodyne = arg;
+    emit heterodyneChanged(arg);
+    updatePatternImages();
+
+    return true;
+}
+
+int ZPhaseShiftPatternProjection::frequencyCount() const
+{
+    return m_frequencyCount;
+}
+
+bool ZPhaseShiftPatternProjection::setFrequencyCount(int arg)
+{
+    if (m_frequencyCount == arg) {
+        return true;
+    }
+
+    m_frequencyCount = arg;
+    emit frequencyCountChanged(arg);
+    updatePatternImages();
+
+    return true;
+}
+
+double ZPhaseShiftPatternProjection::intensity() const
+{
+    return m_intensity;
+}
+
+bool ZPhaseShiftPatternProjection::setIntensity(double arg)
+{
+    if (qFuzzyCompare(m_intensity, arg)) {
+        return true;
+    }
+
+    m_intensity = arg;
+    emit intensityChanged(arg);
+
+    return true;
+}
+
+int ZPhaseShiftPatternProjection::currentPattern() const
+{
+    return m_currentPattern;
+}
+
+bool ZPhaseShiftPatternProjection::setCurrentPattern(int arg)
+{
+    if (m_currentPattern == arg) {
+        return true;
+    }
+
+    m_currentPattern = arg;
+    emit currentPatternChanged(arg);
+
+    return true;
+}
+
+bool ZPhaseShiftPatternProjection::vertical() const
+{
+    return m_vertical;
+}
+
+bool ZPhaseShiftPatternProjection::setVertical(bool arg)
+{
+    if (m_vertical == arg) {
+        return true;
+    }
+
+    m_vertical = arg;
+    emit verticalChanged(arg);
+    updatePatternImages();
+
+    return true;
+}
+
+int ZPhaseShiftPatternProjection::decodeThreads() const
+{
+    return m_decodeThreads;
+}
+
+bool ZPhaseShiftPatternProjection::setDecodeThreads(int arg)
+{
+    if (m_decodeThreads == arg) {
+        return true;
+    }
+
+    m_decodeThreads = arg;
+    emit decodeThreadsChanged(arg);
+
+    return true;
+}
+
+bool ZPhaseShiftPatternProjection::debugMode() const
+{
+    return m_debugMode;
+}
+
+bool ZPhaseShiftPatternProjection::setDebugMode(bool arg)
+{
+    if (m_debugMode == arg) {
+        return true;
+    }
+
+    m_debugMode = arg;
+    emit debugModeChanged(arg);
+
+    return true;
+}
+
+bool ZPhaseShiftPatternProjection::previewEnabled() const
+{
+    return m_previewEnabled;
+}
+
+bool ZPhaseShiftPatternProjection::setPreviewEnabled(bool arg)
+{
+    bool previousPreviewState = m_previewEnabled;
+
+    if (m_previewEnabled != arg) {
+        m_previewEnabled = arg;
+        emit previewEnabledChanged(arg);
+    }
+
+    if (m_previewEnabled)
+        showProjectionWindow();
+    else
+        hideProjectionWindow();
+
+    return previousPreviewState;
+}
+
+int ZPhaseShiftPatternProjection::patternImageCount() const
+{
+    return m_imageProvider->imageCount();
+}
+
+int ZPhaseShiftPatternProjection::patternImagesVersion() const
+{
+    return m_patternImagesVersion;
+}
+
+int ZPhaseShiftPatternProjection::selectedScreen() const
+{
+    const auto screens = qGuiApp->screens();
+    for (int i=0; i<screens.size(); ++i) {
+        const auto &screen = screens[i];
+        if (screen->geometry().contains(m_dlpview->geometry().center())) {
+            return i;
+        }
+    }
+
+    qWarning() << "couldn't find screen being used for pattern projection!";
+
+    return -1;
+}
+
+bool ZPhaseShiftPatternProjection::setSelectedScreen(int index)
+{
+    qDebug() << "setting screen to" << index;
+
+    const QList<QScreen*> screens = qGuiApp->screens();
+    const QRect screenGeometry = screens[index]->geometry();
+    setProjectionWindowGeometry(screenGeometry);
+
+    return true;
+}
+
+void ZPhaseShiftPatternProjection::updatePatternImages()
+{
+    m_imageProvider->renderPatterns(m_dlpview->geometry().size(), m_vertical, m_phaseSteps, m_fringePeriod,
+                                    m_heterodyne ? m_frequencyCount : 0);
+
+    /// make QML reload the images
+    emit patternImagesVersionChanged(++m_patternImagesVersion);
+}
+
+} // namespace Z3D
@@ -0,0 +1,185 @@
+/* * Z3D - A structured light 3D scanner
+ * Copyright (C) 2013-2016 Nicolas Ulrich <nikolaseu@gmail.com>
+ *
+ * This file is part of Z3D.
+ *
+ * Z3D is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Z3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Z3D.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "zpatternprojection.h"
+
+#include <opencv2/core/mat.hpp>
+
+class QQuickView;
+
+namespace Z3D
+{
+
+class ZPhaseShiftPatternImageProvider;
+
+/// N-step phase shifting with a gray code to unwrap the phase.
+/// Gives a sub-pixel projector coordinate for every pixel using far fewer
+/// frames than the binary patterns: 2 reference frames, N sinusoids and
+/// 2 * log2(2 * width / period) gray code frames.
+/// Optionally the phase is unwrapped with several frequencies (heterodyne)
+/// instead of the gray code, using 2 + N * frequencies frames
+class ZPhaseShiftPatternProjection : public ZPatternProjection
+{
+    Q_OBJECT
+
+    Q_PROPERTY(int delayMs READ delayMs WRITE setDelayMs NOTIFY delayMsChanged)
+    Q_PROPERTY(int settleFrames READ settleFrames WRITE setSettleFrames NOTIFY settleFramesChanged)
+    Q_PROPERTY(int noiseThreshold READ noiseThreshold WRITE setNoiseThreshold NOTIFY noiseThresholdChanged)
+    Q_PROPERTY(int minModulation READ minModulation WRITE setMinModulation NOTIFY minModulationChanged)
+    Q_PROPERTY(int phaseSteps READ phaseSteps WRITE setPhaseSteps NOTIFY phaseStepsChanged)
+    Q_PROPERTY(int fringePeriod READ fringePeriod WRITE setFringePeriod NOTIFY fringePeriodChanged)
+    Q_PROPERTY(bool heterodyne READ heterodyne WRITE setHeterodyne NOTIFY heterodyneChanged)
+    Q_PROPERTY(int frequencyCount READ frequencyCount WRITE setFrequencyCount NOTIFY frequencyCountChanged)
+    Q_PROPERTY(double intensity READ intensity WRITE setIntensity NOTIFY intensityChanged)
+    Q_PROPERTY(int currentPattern READ currentPattern WRITE setCurrentPattern NOTIFY currentPatternChanged)
+    Q_PROPERTY(bool vertical READ vertical WRITE setVertical NOTIFY verticalChanged)
+    Q_PROPERTY(int decodeThreads READ decodeThreads WRITE setDecodeThreads NOTIFY decodeThreadsChanged)
+    Q_PROPERTY(bool debugMode READ debugMode WRITE setDebugMode NOTIFY debugModeChanged)
+    Q_PROPERTY(bool previewEnabled READ previewEnabled WRITE setPreviewEnabled NOTIFY previewEnabledChanged)
+    Q_PROPERTY(int patternImageCount READ patternImageCount NOTIFY patternImagesVersionChanged)
+    Q_PROPERTY(int patternImagesVersion READ patternImagesVersion NOTIFY patternImagesVersionChanged)
+
+public:
+    explicit ZPhaseShiftPatternProjection(QObject *parent = nullptr);
+    ~ZPhaseShiftPatternProjection() override;
+
+public:
+    // ZPatternProjection interface
+    virtual const std::vector<ZSettingsItemPtr> &settings() override;
+
+signals:
+    void delayMsChanged(int arg);
+    void settleFramesChanged(int arg);
+    void noiseThresholdChanged(int arg);
+    void minModulationChanged(int arg);
+    void phaseStepsChanged(int arg);
+    void fringePeriodChanged(int arg);
+    void heterodyneChanged(bool arg);
+    void frequencyCountChanged(int arg);
+    void intensityChanged(double arg);
+    void currentPatternChanged(int arg);
+    void verticalChanged(bool arg);
+    void decodeThreadsChanged(int arg);
+    void debugModeChanged(bool arg);
+    void previewEnabledChanged(bool arg);
+    void patternImagesVersionChanged(int arg);
+
+public slots:
+    // ZPatternProjection interface
+    virtual void beginScan() override;
+    virtual void processImages(std::vector< std::vector<Z3D::ZCameraImagePtr> > acquiredImages, QString scanId) override;
+
+    void showProjectionWindow();
+    void hideProjectionWindow();
+    void setProjectionWindowGeometry(const QRect &geometry);
+
+    int delayMs() const;
+    bool setDelayMs(int arg);
+
+    int settleFrames() const;
+    bool setSettleFrames(int arg);
+
+    int noiseThreshold() const;
+    bool setNoiseThreshold(int arg);
+
+    int minModulation() const;
+    bool setMinModulation(int arg);
+
+    int phaseSteps() const;
+    bool setPhaseSteps(int arg);
+
+    int fringePeriod() const;
+    bool setFringePeriod(int arg);
+
+    bool heterodyne() const;
+    bool setHeterodyne(bool arg);
+
+    int frequencyCount() const;
+    bool setFrequencyCount(int arg);
+
+    double intensity() const;
+    bool setIntensity(double arg);
+
+    int currentPattern() const;
+    bool setCurrentPattern(int arg);
+
+    bool vertical() const;
+    bool setVertical(bool arg);
+
+    int decodeThreads() const;
+    bool setDecodeThreads(int arg);
+
+    bool debugMode() const;
+    bool setDebugMode(bool arg);
+
+    bool previewEnabled() const;
+    bool setPreviewEnabled(bool arg);
+
+    int patternImageCount() const;
+    int patternImagesVersion() const;
+
+private slots:
+    int selectedScreen() const;
+    bool setSelectedScreen(int index);
+
+protected:
+    void updatePatternImages();
+
+    /// decoded image as seen from the projector, i.e. the projector
+    /// coordinate of every projector pixel
+    cv::Mat projectorDecodedImage();
+
+    QQuickView *m_dlpview;
+    ZPhaseShiftPatternImageProvider *m_imageProvider;
+    int m_patternImagesVersion;
+
+    int m_delayMs;
+    int m_settleFrames;
+    int m_noiseThreshold;
+    int m_minModulation;
+    int m_phaseSteps;
+    int m_fringePeriod;
+    bool m_heterodyne;
+    int m_frequencyCount;
+    double m_intensity;
+    int m_currentPattern;
+    bool m_vertical;
+    int m_decodeThreads;
+
+    bool m_debugMode;
+    bool m_previewEnabled;
+
+    /// parameters of the last scan, used to decode it
+    int m_scanPhaseSteps;
+    int m_scanFringePeriod;
+    int m_scanGrayCodeBits;
+    int m_scanLength;
+    std::vector<float> m_scanFringePeriods;
+
+    /// only changes with the projector geometry and orientation
+    cv::Mat m_projectorDecodedImage;
+    QString m_projectorDecodedImageKey;
+    uint64_t m_projectorDecodedImageId;
+
+    std::vector<ZSettingsItemPtr> m_settings;
+};
+
+} // namespace Z3D
@@ -0,0 +1,289 @@
+//
+// Z3D - A structured light 3D scanner
+// Copyright (C) 2013-2016 Nicolas Ulrich <nikolaseu@gmail.com>
+//
+// This file is part of Z3D.
+//
+// Z3D is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Z3D is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Z3D.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "zmulticamerasls.h"
+
+#include "zcameraacquisitionmanager.h"
+#include "zcamerainterface.h"
+#include "zcamerapreviewer.h"
+#include "zdecodedpattern.h"
+#include "zmulticameracalibratorwidget.h"
+#include "zpointcloud.h"
+#include "zsettingsitem.h"
+
+#include <QDebug>
+#include <QTime>
+
+#include <cfloat>
+#include <cmath>
+
+namespace Z3D
+{
+
+ZMultiCameraSLS::ZMultiCameraSLS(ZCameraList cameras,
+                                 ZMultiCameraCalibrationPtr calibration,
+                                 ZPatternProjectionPtr patternProjection,
+                                 QObject *parent)
+    : ZStructuredLightSystem(ZCameraAcquisitionManagerPtr(new ZCameraAcquisitionManager(cameras)), patternProjection, parent)
+    , m_cameras(cameras)
+    , m_calibration(calibration)
+    , m_triangulator(calibration->calibrations())
+    , m_maxValidDistance(0.5)
+    , m_minViews(2)
+    , m_minConfidence(0)
+{
+    if (m_cameras.size() < 2 || m_cameras.size() != m_calibration->calibrations().size()) {
+        qWarning() << "there must be at least 2 cameras, and one calibration for each!";
+        return;
+    }
+
+    /// the rays are built as soon as every camera calibration is ready
+    for (const auto &cameraCalibration : m_calibration->calibrations()) {
+        connect(cameraCalibration.get(), &ZCameraCalibration::calibrationReadyChanged,
+                this, &ZMultiCameraSLS::onCalibrationReadyChanged);
+    }
+    onCalibrationReadyChanged();
+
+    const QString calibrationSettings("Calibration");
+
+    ZSettingsItemPtr openCalibrationOption = std::make_unique<ZSettingsItemCommand>(calibrationSettings, "Change calibration ...", "Opens structured light system calibration window",
+                                                                                    [&]() -> bool {
+                                                                                        Z3D::ZMultiCameraCalibratorWidget *calibWidget = new Z3D::ZMultiCameraCalibratorWidget(m_cameras);
+                                                                                        calibWidget->show();
+                                                                                        return true;
+                                                                                    });
+
+    m_settings = {
+        openCalibrationOption
+    };
+
+    for (size_t iCam=0; iCam<m_cameras.size(); ++iCam) {
+        const QString cameraSettings = QString("Camera %1").arg(iCam + 1);
+        const ZCameraPtr camera = m_cameras[iCam];
+
+        ZSettingsItemPtr cameraPreviewOption = std::make_unique<ZSettingsItemCommand>(cameraSettings, "Preview ...", "Opens camera preview window",
+                                                                                      [camera]() -> bool {
+                                                                                          auto *previewDialog = new Z3D::ZCameraPreviewer(camera);
+                                                                                          previewDialog->show();
+                                                                                          return true;
+                                                                                      });
+
+        ZSettingsItemPtr cameraSettingsOption = std::make_unique<ZSettingsItemCommand>(cameraSettings, "Settings ...", "Opens camera settings window",
+                                                                                       [camera]() -> bool {
+                                                                                           camera->showSettingsDialog();
+                                                                                           return true;
+                                                                                       });
+
+        m_settings.push_back(cameraPreviewOption);
+        m_settings.push_back(cameraSettingsOption);
+    }
+
+    const QString advancedSettings("Advanced options");
+
+    ZSettingsItemPtr maxValidDistanceOption = std::make_unique<ZSettingsItemFloat>(advancedSettings, "Max. valid distance", "Maximum distance between a point and the rays it's computed from, in calibration units",
+                                                                                   std::bind(&ZMultiCameraSLS::maxValidDistance, this),
+                                                                                   std::bind(&ZMultiCameraSLS::setMaxValidDistance, this, std::placeholders::_1),
+                                                                                   0.0, // minimum
+                                                                                   10.0); // maximum
+    QObject::connect(this, &ZMultiCameraSLS::maxValidDistanceChanged,
+                     maxValidDistanceOption.get(), &ZSettingsItem::valueChanged);
+
+    ZSettingsItemPtr minViewsOption = std::make_unique<ZSettingsItemInt>(advancedSettings, "Min. cameras per point", "Points seen by less cameras than this are discarded",
+                                                                         std::bind(&ZMultiCameraSLS::minViews, this),
+                                                                         std::bind(&ZMultiCameraSLS::setMinViews, this, std::placeholders::_1),
+                                                                         2, // minimum
+                                                                         int(m_cameras.size())); // maximum
+    QObject::connect(this, &ZMultiCameraSLS::minViewsChanged,
+                     minViewsOption.get(), &ZSettingsItem::valueChanged);
+
+    ZSettingsItemPtr autoRoiOption = std::make_unique<ZSettingsItemBool>(advancedSettings, "Auto region of interest", "Only decode and triangulate the part of the images lit by the projector",
+                                                                         std::bind(&ZMultiCameraSLS::autoRoi, this),
+                                                                         std::bind(&ZMultiCameraSLS::setAutoRoi, this, std::placeholders::_1));
+    QObject::connect(this, &ZMultiCameraSLS::autoRoiChanged,
+                     autoRoiOption.get(), &ZSettingsItem::valueChanged);
+
+    ZSettingsItemPtr minConfidenceOption = std::make_unique<ZSettingsItemInt>(advancedSettings, "Min. decoding confidence", "Pixels decoded with less contrast than this are not used to find correspondences",
+                                                                              std::bind(&ZMultiCameraSLS::minConfidence, this),
+                                                                              std::bind(&ZMultiCameraSLS::setMinConfidence, this, std::placeholders::_1),
+                                                                              0, // minimum
+                                                                              255); // maximum
+    QObject::connect(this, &ZMultiCameraSLS::minConfidenceChanged,
+                     minConfidenceOption.get(), &ZSettingsItem::valueChanged);
+
+    ZSettingsItemPtr floatDecodedImagesOption = std::make_unique<ZSettingsItemBool>(advancedSettings, "Floating point decoded images", "Decode to floating point instead of 16 bit fixed point images, more precision for phase shift codes but twice the memory",
+                                                                                    std::bind(&ZMultiCameraSLS::floatDecodedImages, this),
+                                                                                    std::bind(&ZMultiCameraSLS::setFloatDecodedImages, this, std::placeholders::_1));
+    QObject::connect(this, &ZMultiCameraSLS::floatDecodedImagesChanged,
+                     floatDecodedImagesOption.get(), &ZSettingsItem::valueChanged);
+
+    const QString debugOptions("Debug options");
+
+    ZSettingsItemPtr showDecodedPatternOption = std::make_unique<ZSettingsItemBool>(debugOptions, "Show decoded patterns", "Display decoded patterns as images (in a new window)",
+                                                                                    std::bind(&ZMultiCameraSLS::debugShowDecodedImages, this),
+                                                                                    std::bind(&ZMultiCameraSLS::setDebugShowDecodedImages, this, std::placeholders::_1));
+    QObject::connect(this, &ZMultiCameraSLS::debugShowDecodedImagesChanged,
+                     showDecodedPatternOption.get(), &ZSettingsItem::valueChanged);
+
+    m_settings.push_back(maxValidDistanceOption);
+    m_settings.push_back(minViewsOption);
+    m_settings.push_back(autoRoiOption);
+    m_settings.push_back(minConfidenceOption);
+    m_settings.push_back(floatDecodedImagesOption);
+    m_settings.push_back(showDecodedPatternOption);
+}
+
+ZMultiCameraSLS::~ZMultiCameraSLS()
+{
+
+}
+
+const std::vector<ZSettingsItemPtr> &ZMultiCameraSLS::settings()
+{
+    qDebug() << "returning settings for" << this;
+    return m_settings;
+}
+
+ZCameraList ZMultiCameraSLS::cameras() const
+{
+    return m_cameras;
+}
+
+double ZMultiCameraSLS::maxValidDistance() const
+{
+    return m_maxValidDistance;
+}
+
+int ZMultiCameraSLS::minViews() const
+{
+    return m_minViews;
+}
+
+int ZMultiCameraSLS::minConfidence() const
+{
+    return m_minConfidence;
+}
+
+bool ZMultiCameraSLS::setMaxValidDistance(double maxValidDistance)
+{
+    if (std::fabs(m_maxValidDistance - maxValidDistance) < DBL_EPSILON) {
+        return true;
+    }
+
+    m_maxValidDistance = maxValidDistance;
+    emit maxValidDistanceChanged(maxValidDistance);
+
+    return true;
+}
+
+bool ZMultiCameraSLS::setMinViews(int minViews)
+{
+    if (minViews < 2 || minViews > int(m_cameras.size())) {
+        qWarning() << "invalid min. cameras per point:" << minViews;
+        return false;
+    }
+
+    if (m_minViews == minViews) {
+        return true;
+    }
+
+    m_minViews = minViews;
+    emit minViewsChanged(minViews);
+
+    return true;
+}
+
+bool ZMultiCameraSLS::setMinConfidence(int minConfidence)
+{
+    if (minConfidence < 0 || minConfidence > 255) {
+        qWarning() << "invalid min. confidence:" << minConfidence;
+        return false;
+    }
+
+    if (m_minConfidence == minConfidence) {
+        return true;
+    }
+
+    m_minConfidence = minConfidence;
+    emit minConfidenceChanged(minConfidence);
+
+    return true;
+}
+
+void ZMultiCameraSLS::onPatternProjected(ZProjectedPatternPtr pattern)
+{
+    Q_UNUSED(pattern);
+}
+
+void ZMultiCameraSLS::onPatternsDecoded(std::vector<ZDecodedPatternPtr> decodedPatterns)
+{
+    if (decodedPatterns.size() != m_cameras.size()) {
+        qWarning() << "expected" << m_cameras.size() << "decoded patterns, got" << decodedPatterns.size();
+        return;
+    }
+
+    QTime startTime;
+    startTime.start();
+
+    std::vector<cv::Mat> intensityImages;
+    std::vector<cv::Mat> decodedImages;
+    std::vector<cv::Rect> rois;
+    int decodedViews = 0;
+    for (const auto &decodedPattern : decodedPatterns) {
+        intensityImages.push_back(decodedPattern->intensityImg());
+        decodedImages.push_back(decodedPattern->decodedImage(m_minConfidence));
+        rois.push_back(decodedPattern->roi());
+        /// an empty roi means nothing was decoded, its decoded image is
+        /// all NO_VALUE so the camera doesn't add any view
+        if (!decodedPattern->roi().empty()) {
+            ++decodedViews;
+        }
+    }
+
+    if (decodedViews < m_minViews) {
+        qDebug() << "only" << decodedViews << "cameras decoded something, no point cloud to calculate";
+        return;
+    }
+
+    const float maxDistance = float(m_maxValidDistance);
+    Z3D::ZPointCloudPtr cloud = m_triangulator.triangulate(intensityImages, decodedImages, rois,
+                                                           maxDistance * maxDistance, size_t(m_minViews));
+
+    if (cloud) {
+        qDebug() << "finished calculating point cloud with" << cloud->width() * cloud->height()
+                 << "points in" << startTime.elapsed() << "msecs";
+        emit scanFinished(cloud);
+    } else {
+        qDebug() << "finished calculating point cloud in" << startTime.elapsed() << "msecs";
+    }
+}
+
+void ZMultiCameraSLS::onCalibrationReadyChanged()
+{
+    for (const auto &cameraCalibration : m_calibration->calibrations()) {
+        if (!cameraCalibration->ready()) {
+            setReady(false);
+            return;
+        }
+    }
+
+    setReady(m_triangulator.updateRays());
+}
+
+} // namespace Z3D
@@ -0,0 +1,91 @@
+/* * Z3D - A structured light 3D scanner
+ * Copyright (C) 2013-2016 Nicolas Ulrich <nikolaseu@gmail.com>
+ *
+ * This file is part of Z3D.
+ *
+ * Z3D is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Z3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Z3D.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include "zstructuredlightsystem.h"
+#include "zraytriangulator.h"
+
+#include <Z3DCameraAcquisition>
+#include <Z3DCameraCalibration>
+
+namespace Z3D
+{
+
+/// Any number of cameras (at least two) around one projector. Every camera
+/// pixel is matched with the other cameras by its code, and each point is
+/// triangulated from all the cameras that see it, so a scan gives a single
+/// merged cloud
+class ZMultiCameraSLS : public ZStructuredLightSystem
+{
+    Q_OBJECT
+
+    Q_PROPERTY(double maxValidDistance READ maxValidDistance WRITE setMaxValidDistance NOTIFY maxValidDistanceChanged)
+    Q_PROPERTY(int minViews READ minViews WRITE setMinViews NOTIFY minViewsChanged)
+    Q_PROPERTY(int minConfidence READ minConfidence WRITE setMinConfidence NOTIFY minConfidenceChanged)
+
+public:
+    explicit ZMultiCameraSLS(ZCameraList cameras,
+                             ZMultiCameraCalibrationPtr calibration,
+                             ZPatternProjectionPtr patternProjection,
+                             QObject *parent = nullptr);
+
+    ~ZMultiCameraSLS() override;
+
+    // ZStructuredLightSystem interface
+    virtual const std::vector<ZSettingsItemPtr> &settings() override;
+
+    Z3D::ZCameraList cameras() const;
+
+    double maxValidDistance() const;
+    int minViews() const;
+    int minConfidence() const;
+
+signals:
+    void maxValidDistanceChanged(double maxValidDistance);
+    void minViewsChanged(int minViews);
+    void minConfidenceChanged(int minConfidence);
+
+public slots:
+    bool setMaxValidDistance(double maxValidDistance);
+    bool setMinViews(int minViews);
+    bool setMinConfidence(int minConfidence);
+
+    // ZStructuredLightSystem interface
+protected slots:
+    virtual void onPatternProjected(ZProjectedPatternPtr pattern) override;
+    virtual void onPatternsDecoded(std::vector<ZDecodedPatternPtr> patterns) override;
+
+private slots:
+    void onCalibrationReadyChanged();
+
+private:
+    ZCameraList m_cameras;
+    ZMultiCameraCalibrationPtr m_calibration;
+    ZRayTriangulator m_triangulator;
+
+    double m_maxValidDistance;
+    int m_minViews;
+    int m_minConfidence;
+
+    std::vector<ZSettingsItemPtr> m_settings;
+};
+
+} // namespace Z3D
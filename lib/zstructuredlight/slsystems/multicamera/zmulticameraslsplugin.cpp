@@ -0,0 +1,80 @@
+//
+// Z3D - A structured light 3D scanner
+// Copyright (C) 2013-2016 Nicolas Ulrich <nikolaseu@gmail.com>
+//
+// This file is part of Z3D.
+//
+// Z3D is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Z3D is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Z3D.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "zmulticameraslsplugin.h"
+
+#include "zcameracalibrationprovider.h"
+#include "zcameraprovider.h"
+#include "zmulticamerasls.h"
+#include "zpatternprojectionprovider.h"
+
+#include <QDebug>
+#include <QSettings>
+
+namespace Z3D {
+
+ZMultiCameraSLSPlugin::ZMultiCameraSLSPlugin()
+{
+
+}
+
+ZStructuredLightSystemPtr ZMultiCameraSLSPlugin::get(QSettings *settings)
+{
+    settings->beginGroup("Calibration");
+    auto calibration = ZCameraCalibrationProvider::getMultiCameraCalibration(settings);
+    settings->endGroup();
+
+    if (!calibration) {
+        qWarning() << "failed to load multi camera calibration";
+        return nullptr;
+    }
+
+    auto patternProjection = ZPatternProjectionProvider::get(settings);
+    if (!patternProjection) {
+        qWarning() << "failed to load pattern projection";
+        return nullptr;
+    }
+
+    /// any number of cameras, in the same order as in the calibration
+    ZCameraList cameras;
+    const int cameraCount = settings->beginReadArray("Cameras");
+    for (int i=0; i<cameraCount; ++i) {
+        settings->setArrayIndex(i);
+        cameras.push_back(ZCameraProvider::getCamera(settings));
+    }
+    settings->endArray();
+
+    for (auto camera : cameras) {
+        if (!camera) {
+            qWarning() << "failed to load cameras";
+            return nullptr;
+        }
+    }
+
+    if (cameras.size() < 2 || cameras.size() != calibration->calibrations().size()) {
+        qWarning() << "there must be at least 2 cameras, and one calibration for each, got"
+                   << cameras.size() << "cameras and" << calibration->calibrations().size() << "calibrations";
+        return nullptr;
+    }
+
+    return ZStructuredLightSystemPtr(new ZMultiCameraSLS(cameras, calibration, patternProjection));
+}
+
+} // namespace Z3D
@@ -17,22 +17,26 @@
  * along with Z3D.  If not, see <http://www.gnu.org/licenses/>.
  */
 
-#pragma once
 
-#include <opencv2/core/mat.hpp>
+#pragma once
 
-#include <map>
+#include "zstructuredlightsystemplugin.h"
 
 namespace Z3D
 {
 
-namespace ZBinaryPatternDecoder
+class ZMultiCameraSLSPlugin : public QObject, public ZStructuredLightSystemPlugin
 {
+    Q_OBJECT
+    Q_PLUGIN_METADATA(IID "z3d.zstructuredlight.zstructuredlightsystemplugin" FILE "zmulticameraslsplugin.json")
+    Q_INTERFACES(Z3D::ZStructuredLightSystemPlugin)
 
-cv::Mat decodeBinaryPatternImages(const std::vector<cv::Mat> &images, const std::vector<cv::Mat> &invImages, cv::Mat maskImg, bool isGrayCode = true);
-
-cv::Mat simplifyBinaryPatternData(cv::Mat image, cv::Mat maskImg, std::map<int, std::vector<cv::Vec2f> > &fringePoints);
+public:
+    ZMultiCameraSLSPlugin();
 
-} // namespace ZBinaryPatternDecoder
+    // ZStructuredLightSystemPlugin interface
+public:
+    ZStructuredLightSystemPtr get(QSettings *settings) override;
+};
 
-}// namespace Z3D
+} // namespace Z3D
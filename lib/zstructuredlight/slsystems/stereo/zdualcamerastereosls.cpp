@@ -87,14 +87,55 @@ ZDualCameraStereoSLS::ZDualCameraStereoSLS(ZCameraList cameras,
 
     const QString advancedSettings("Advanced options");
 
-    ZSettingsItemPtr maxValidDistanceOption = std::make_unique<ZSettingsItemFloat>(advancedSettings, "Max. valid distance", "Maximum distance to be considered valid",
+    ZSettingsItemPtr maxValidDistanceOption = std::make_unique<ZSettingsItemFloat>(advancedSettings, "Max. valid distance", "Maximum distance between the rays of a match to be considered valid (ray intersection only), in calibration units",
                                                                                    std::bind(&ZDualCameraStereoSLS::maxValidDistance, this),
                                                                                    std::bind(&ZDualCameraStereoSLS::setMaxValidDistance, this, std::placeholders::_1),
                                                                                    0.0, // minimum
-                                                                                   1.0); // maximum
+                                                                                   10.0); // maximum
     QObject::connect(this, &ZDualCameraStereoSLS::maxValidDistanceChanged,
                      maxValidDistanceOption.get(), &ZSettingsItem::valueChanged);
 
+    ZSettingsItemPtr matchingMethodOption = std::make_unique<ZSettingsItemEnum>(advancedSettings, "Matching method", "Method used to find correspondences between left and right images",
+                                                                                [](){
+                                                                                    return std::vector<QString> { "Linear scan", "Sorted index (sub-pixel)", "Ray intersection (no rectification)" };
+                                                                                },
+                                                                                std::bind(&ZDualCameraStereoSLS::matchingMethod, this),
+                                                                                std::bind(&ZDualCameraStereoSLS::setMatchingMethod, this, std::placeholders::_1));
+    QObject::connect(this, &ZDualCameraStereoSLS::matchingMethodChanged,
+                     matchingMethodOption.get(), &ZSettingsItem::valueChanged);
+
+    ZSettingsItemPtr organizedOutputOption = std::make_unique<ZSettingsItemBool>(advancedSettings, "Organized point cloud", "Keep one point per pixel (invalid points are NaN), so neighbours can be found in image space",
+                                                                                 std::bind(&ZDualCameraStereoSLS::organizedOutput, this),
+                                                                                 std::bind(&ZDualCameraStereoSLS::setOrganizedOutput, this, std::placeholders::_1));
+    QObject::connect(this, &ZDualCameraStereoSLS::organizedOutputChanged,
+                     organizedOutputOption.get(), &ZSettingsItem::valueChanged);
+
+    ZSettingsItemPtr cacheRectificationMapsOption = std::make_unique<ZSettingsItemBool>(advancedSettings, "Cache rectification maps", "Save rectification maps to disk, so they are not computed again for the same calibration",
+                                                                                        std::bind(&ZDualCameraStereoSLS::cacheRectificationMaps, this),
+                                                                                        std::bind(&ZDualCameraStereoSLS::setCacheRectificationMaps, this, std::placeholders::_1));
+    QObject::connect(this, &ZDualCameraStereoSLS::cacheRectificationMapsChanged,
+                     cacheRectificationMapsOption.get(), &ZSettingsItem::valueChanged);
+
+    ZSettingsItemPtr autoRoiOption = std::make_unique<ZSettingsItemBool>(advancedSettings, "Auto region of interest", "Only decode and triangulate the part of the images lit by the projector",
+                                                                         std::bind(&ZDualCameraStereoSLS::autoRoi, this),
+                                                                         std::bind(&ZDualCameraStereoSLS::setAutoRoi, this, std::placeholders::_1));
+    QObject::connect(this, &ZDualCameraStereoSLS::autoRoiChanged,
+                     autoRoiOption.get(), &ZSettingsItem::valueChanged);
+
+    ZSettingsItemPtr minConfidenceOption = std::make_unique<ZSettingsItemInt>(advancedSettings, "Min. decoding confidence", "Pixels decoded with less contrast than this are not used to find correspondences",
+                                                                              std::bind(&ZDualCameraStereoSLS::minConfidence, this),
+                                                                              std::bind(&ZDualCameraStereoSLS::setMinConfidence, this, std::placeholders::_1),
+                                                                              0, // minimum
+                                                                              255); // maximum
+    QObject::connect(this, &ZDualCameraStereoSLS::minConfidenceChanged,
+                     minConfidenceOption.get(), &ZSettingsItem::valueChanged);
+
+    ZSettingsItemPtr floatDecodedImagesOption = std::make_unique<ZSettingsItemBool>(advancedSettings, "Floating point decoded images", "Decode to floating point instead of 16 bit fixed point images, more precision for phase shift codes but twice the memory",
+                                                                                    std::bind(&ZDualCameraStereoSLS::floatDecodedImages, this),
+                                                                                    std::bind(&ZDualCameraStereoSLS::setFloatDecodedImages, this, std::placeholders::_1));
+    QObject::connect(this, &ZDualCameraStereoSLS::floatDecodedImagesChanged,
+                     floatDecodedImagesOption.get(), &ZSettingsItem::valueChanged);
+
     const QString debugOptions("Debug options");
 
     ZSettingsItemPtr showDecodedPatternOption = std::make_unique<ZSettingsItemBool>(debugOptions, "Show decoded patterns", "Display decoded patterns as images (in a new window)",
@@ -110,6 +151,12 @@ ZDualCameraStereoSLS::ZDualCameraStereoSLS(ZCameraList cameras,
         rightCameraPreviewOption,
         rightCameraSettingsOption,
         maxValidDistanceOption,
+        matchingMethodOption,
+        organizedOutputOption,
+        cacheRectificationMapsOption,
+        autoRoiOption,
+        minConfidenceOption,
+        floatDecodedImagesOption,
         showDecodedPatternOption
     };
 }
@@ -137,12 +184,20 @@ void ZDualCameraStereoSLS::onPatternProjected(ZProjectedPatternPtr pattern)
 
 void ZDualCameraStereoSLS::onPatternsDecoded(std::vector<ZDecodedPatternPtr> decodedPatterns)
 {
+    /// an empty roi means nothing was decoded, there can't be any match
+    if (decodedPatterns[0]->roi().empty() || decodedPatterns[1]->roi().empty()) {
+        qDebug() << "nothing decoded, no point cloud to calculate";
+        return;
+    }
+
     QTime startTime;
     startTime.start();
 
     Z3D::ZPointCloudPtr cloud = triangulate(decodedPatterns[0]->intensityImg(),
-            decodedPatterns[0]->decodedImage(),
-            decodedPatterns[1]->decodedImage());
+            decodedPatterns[0]->decodedImage(minConfidence()),
+            decodedPatterns[1]->decodedImage(minConfidence()),
+            decodedPatterns[0]->roi(),
+            decodedPatterns[1]->roi());
 
     if (cloud) {
         qDebug() << "finished calculating point cloud with" << cloud->width() * cloud->height()
@@ -20,8 +20,13 @@
 
 #include "zsinglecamerastereosls.h"
 
+#include "zcamerainterface.h"
+#include "zcamerapreviewer.h"
 #include "zdecodedpattern.h"
+#include "zpointcloud.h"
 #include "zprojectedpattern.h"
+#include "zsettingsitem.h"
+#include "zstereosystemimpl.h"
 
 #include <QDebug>
 
@@ -34,8 +39,101 @@ ZSingleCameraStereoSLS::ZSingleCameraStereoSLS(
         ZPatternProjectionPtr patternProjection,
         QObject *parent)
     : ZStereoSLS({ camera }, stereoCalibration, patternProjection, parent)
+    , m_camera(camera)
 {
-
+    /// the projector is used as an inverse camera, usually with a different
+    /// resolution than the camera, so both images can't share the rectified
+    /// image size the rectified methods need. Every projector code is a
+    /// plane of light, so there's no need to search for correspondences
+    setMatchingMethod(ZStereoSystemImpl::LightPlaneMatching);
+
+    const QString cameraSettings("Camera");
+
+    ZSettingsItemPtr cameraPreviewOption = std::make_unique<ZSettingsItemCommand>(cameraSettings, "Preview ...", "Opens camera preview window",
+                                                                                  [&]() -> bool {
+                                                                                      auto *previewDialog = new Z3D::ZCameraPreviewer(m_camera);
+                                                                                      previewDialog->show();
+                                                                                      return true;
+                                                                                  });
+
+    ZSettingsItemPtr cameraSettingsOption = std::make_unique<ZSettingsItemCommand>(cameraSettings, "Settings ...", "Opens camera settings window",
+                                                                                   [&]() -> bool {
+                                                                                       m_camera->showSettingsDialog();
+                                                                                       return true;
+                                                                                   });
+
+    const QString advancedSettings("Advanced options");
+
+    ZSettingsItemPtr maxValidDistanceOption = std::make_unique<ZSettingsItemFloat>(advancedSettings, "Max. valid distance", "Maximum distance between the camera ray and the projector ray of a match to be considered valid, in calibration units",
+                                                                                   std::bind(&ZSingleCameraStereoSLS::maxValidDistance, this),
+                                                                                   std::bind(&ZSingleCameraStereoSLS::setMaxValidDistance, this, std::placeholders::_1),
+                                                                                   0.0, // minimum
+                                                                                   10.0); // maximum
+    QObject::connect(this, &ZSingleCameraStereoSLS::maxValidDistanceChanged,
+                     maxValidDistanceOption.get(), &ZSettingsItem::valueChanged);
+
+    /// only the methods that work against a projector are offered, the
+    /// option index is relative to the first one
+    ZSettingsItemPtr matchingMethodOption = std::make_unique<ZSettingsItemEnum>(advancedSettings, "Matching method", "Method used to find correspondences between camera and projector",
+                                                                                [](){
+                                                                                    return std::vector<QString> { "Ray intersection", "Light planes (no search)" };
+                                                                                },
+                                                                                [&]() -> int {
+                                                                                    return matchingMethod() - ZStereoSystemImpl::RayIntersectionMatching;
+                                                                                },
+                                                                                [&](int index) -> bool {
+                                                                                    if (index < 0) {
+                                                                                        return false;
+                                                                                    }
+                                                                                    return setMatchingMethod(ZStereoSystemImpl::RayIntersectionMatching + index);
+                                                                                });
+    QObject::connect(this, &ZSingleCameraStereoSLS::matchingMethodChanged,
+                     matchingMethodOption.get(), &ZSettingsItem::valueChanged);
+
+    ZSettingsItemPtr organizedOutputOption = std::make_unique<ZSettingsItemBool>(advancedSettings, "Organized point cloud", "Keep one point per pixel (invalid points are NaN), so neighbours can be found in image space",
+                                                                                 std::bind(&ZSingleCameraStereoSLS::organizedOutput, this),
+                                                                                 std::bind(&ZSingleCameraStereoSLS::setOrganizedOutput, this, std::placeholders::_1));
+    QObject::connect(this, &ZSingleCameraStereoSLS::organizedOutputChanged,
+                     organizedOutputOption.get(), &ZSettingsItem::valueChanged);
+
+    ZSettingsItemPtr autoRoiOption = std::make_unique<ZSettingsItemBool>(advancedSettings, "Auto region of interest", "Only decode and triangulate the part of the image lit by the projector",
+                                                                         std::bind(&ZSingleCameraStereoSLS::autoRoi, this),
+                                                                         std::bind(&ZSingleCameraStereoSLS::setAutoRoi, this, std::placeholders::_1));
+    QObject::connect(this, &ZSingleCameraStereoSLS::autoRoiChanged,
+                     autoRoiOption.get(), &ZSettingsItem::valueChanged);
+
+    ZSettingsItemPtr minConfidenceOption = std::make_unique<ZSettingsItemInt>(advancedSettings, "Min. decoding confidence", "Pixels decoded with less contrast than this are not triangulated",
+                                                                              std::bind(&ZSingleCameraStereoSLS::minConfidence, this),
+                                                                              std::bind(&ZSingleCameraStereoSLS::setMinConfidence, this, std::placeholders::_1),
+                                                                              0, // minimum
+                                                                              255); // maximum
+    QObject::connect(this, &ZSingleCameraStereoSLS::minConfidenceChanged,
+                     minConfidenceOption.get(), &ZSettingsItem::valueChanged);
+
+    ZSettingsItemPtr floatDecodedImagesOption = std::make_unique<ZSettingsItemBool>(advancedSettings, "Floating point decoded images", "Decode to floating point instead of 16 bit fixed point images, more precision for phase shift codes but twice the memory",
+                                                                                    std::bind(&ZSingleCameraStereoSLS::floatDecodedImages, this),
+                                                                                    std::bind(&ZSingleCameraStereoSLS::setFloatDecodedImages, this, std::placeholders::_1));
+    QObject::connect(this, &ZSingleCameraStereoSLS::floatDecodedImagesChanged,
+                     floatDecodedImagesOption.get(), &ZSettingsItem::valueChanged);
+
+    const QString debugOptions("Debug options");
+
+    ZSettingsItemPtr showDecodedPatternOption = std::make_unique<ZSettingsItemBool>(debugOptions, "Show decoded patterns", "Display decoded patterns as images (in a new window)",
+                                                                                    std::bind(&ZSingleCameraStereoSLS::debugShowDecodedImages, this),
+                                                                                    std::bind(&ZSingleCameraStereoSLS::setDebugShowDecodedImages, this, std::placeholders::_1));
+    QObject::connect(this, &ZSingleCameraStereoSLS::debugShowDecodedImagesChanged,
+                     showDecodedPatternOption.get(), &ZSettingsItem::valueChanged);
+
+    m_settings = {
+        cameraPreviewOption,
+        cameraSettingsOption,
+        maxValidDistanceOption,
+        organizedOutputOption,
+        autoRoiOption,
+        minConfidenceOption,
+        floatDecodedImagesOption,
+        showDecodedPatternOption
+    };
 }
 
 ZSingleCameraStereoSLS::~ZSingleCameraStereoSLS()
@@ -57,8 +155,11 @@ void ZSingleCameraStereoSLS::processPatterns()
     }
 
     Z3D::ZPointCloudPtr cloud = triangulate(decodedPatterns[0]->intensityImg(),
-            decodedPatterns[0]->decodedImage(),
-            projectedPattern->decodedImage());
+            decodedPatterns[0]->decodedImage(minConfidence()),
+            projectedPattern->decodedImage(),
+            decodedPatterns[0]->roi(),
+            cv::Rect(),
+            projectedPattern->decodedImageId());
 
     if (cloud) {
         emit scanFinished(cloud);
@@ -70,7 +171,9 @@ void ZSingleCameraStereoSLS::processPatterns()
 
 void ZSingleCameraStereoSLS::onPatternProjected(ZProjectedPatternPtr pattern)
 {
-    if (pattern && pattern->estimatedCloudPoints() > 0) {
+    /// the projector decoded image is synthesized by the pattern projection,
+    /// there's nothing to triangulate against without it
+    if (pattern && !pattern->decodedImage().empty()) {
         projectedPattern = pattern;
         processPatterns();
     } else {
@@ -81,7 +184,8 @@ void ZSingleCameraStereoSLS::onPatternProjected(ZProjectedPatternPtr pattern)
 void ZSingleCameraStereoSLS::onPatternsDecoded(std::vector<ZDecodedPatternPtr> patterns)
 {
     for (const auto &decodedPattern : patterns) {
-        if (decodedPattern->estimatedCloudPoints() < 1) {
+        /// an empty roi means nothing was decoded
+        if (decodedPattern->decodedImage().empty() || decodedPattern->roi().empty()) {
             projectedPattern = nullptr;
             return;
         }
@@ -44,6 +44,8 @@ public:
 private:
     void processPatterns();
 
+    ZCameraPtr m_camera;
+
     ZProjectedPatternPtr projectedPattern;
     std::vector<ZDecodedPatternPtr> decodedPatterns;
 
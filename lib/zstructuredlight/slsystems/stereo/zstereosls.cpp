@@ -33,7 +33,7 @@ ZStereoSLS::ZStereoSLS(ZCameraList cameras,
                        ZPatternProjectionPtr patternProjection,
                        QObject *parent)
     : ZStructuredLightSystem(ZCameraAcquisitionManagerPtr(new ZCameraAcquisitionManager(cameras)), patternProjection, parent)
-    , m_maxValidDistance(0.001)
+    , m_minConfidence(0)
     , m_stereoSystem(new ZStereoSystemImpl(stereoCalibration))
 {
     connect(m_stereoSystem, &ZStereoSystemImpl::readyChanged,
@@ -48,26 +48,108 @@ ZStereoSLS::~ZStereoSLS()
 
 double ZStereoSLS::maxValidDistance() const
 {
-    return m_maxValidDistance;
+    return m_stereoSystem->maxValidDistance();
 }
 
 bool ZStereoSLS::setMaxValidDistance(double maxValidDistance)
 {
-    if (std::fabs(m_maxValidDistance - maxValidDistance) < DBL_EPSILON) {
+    if (std::fabs(m_stereoSystem->maxValidDistance() - maxValidDistance) < DBL_EPSILON) {
         return true;
     }
 
-    m_maxValidDistance = maxValidDistance;
+    m_stereoSystem->setMaxValidDistance(maxValidDistance);
     emit maxValidDistanceChanged(maxValidDistance);
 
     return true;
 }
 
+int ZStereoSLS::matchingMethod() const
+{
+    return m_stereoSystem->matchingMethod();
+}
+
+bool ZStereoSLS::setMatchingMethod(int matchingMethod)
+{
+    if (matchingMethod < ZStereoSystemImpl::LinearScanMatching || matchingMethod > ZStereoSystemImpl::LightPlaneMatching) {
+        qWarning() << "invalid matching method:" << matchingMethod;
+        return false;
+    }
+
+    if (m_stereoSystem->matchingMethod() == matchingMethod) {
+        return true;
+    }
+
+    m_stereoSystem->setMatchingMethod(ZStereoSystemImpl::MatchingMethod(matchingMethod));
+    emit matchingMethodChanged(matchingMethod);
+
+    return true;
+}
+
+bool ZStereoSLS::organizedOutput() const
+{
+    return m_stereoSystem->organizedOutput();
+}
+
+bool ZStereoSLS::setOrganizedOutput(bool organizedOutput)
+{
+    if (m_stereoSystem->organizedOutput() == organizedOutput) {
+        return true;
+    }
+
+    m_stereoSystem->setOrganizedOutput(organizedOutput);
+    emit organizedOutputChanged(organizedOutput);
+
+    return true;
+}
+
+bool ZStereoSLS::cacheRectificationMaps() const
+{
+    return m_stereoSystem->diskCacheEnabled();
+}
+
+bool ZStereoSLS::setCacheRectificationMaps(bool cacheRectificationMaps)
+{
+    if (m_stereoSystem->diskCacheEnabled() == cacheRectificationMaps) {
+        return true;
+    }
+
+    /// only used the next time the maps are computed
+    m_stereoSystem->setDiskCacheEnabled(cacheRectificationMaps);
+    emit cacheRectificationMapsChanged(cacheRectificationMaps);
+
+    return true;
+}
+
+int ZStereoSLS::minConfidence() const
+{
+    return m_minConfidence;
+}
+
+bool ZStereoSLS::setMinConfidence(int minConfidence)
+{
+    if (minConfidence < 0 || minConfidence > 255) {
+        qWarning() << "invalid min. confidence:" << minConfidence;
+        return false;
+    }
+
+    if (m_minConfidence == minConfidence) {
+        return true;
+    }
+
+    m_minConfidence = minConfidence;
+    emit minConfidenceChanged(minConfidence);
+
+    return true;
+}
+
 ZPointCloudPtr ZStereoSLS::triangulate(const cv::Mat &colorImg,
                                        const cv::Mat &leftDecodedImage,
-                                       const cv::Mat &rightDecodedImage)
+                                       const cv::Mat &rightDecodedImage,
+                                       const cv::Rect &leftRoi,
+                                       const cv::Rect &rightRoi,
+                                       uint64_t rightDecodedImageId)
 {
-    return m_stereoSystem->triangulate(colorImg, leftDecodedImage, rightDecodedImage);
+    return m_stereoSystem->triangulate(colorImg, leftDecodedImage, rightDecodedImage, leftRoi, rightRoi, rightDecodedImageId);
 }
 
 } // namespace Z3D
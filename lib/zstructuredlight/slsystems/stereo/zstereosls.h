@@ -36,6 +36,10 @@ class ZStereoSLS : public ZStructuredLightSystem
     Q_OBJECT
 
     Q_PROPERTY(double maxValidDistance READ maxValidDistance WRITE setMaxValidDistance NOTIFY maxValidDistanceChanged)
+    Q_PROPERTY(int matchingMethod READ matchingMethod WRITE setMatchingMethod NOTIFY matchingMethodChanged)
+    Q_PROPERTY(bool organizedOutput READ organizedOutput WRITE setOrganizedOutput NOTIFY organizedOutputChanged)
+    Q_PROPERTY(bool cacheRectificationMaps READ cacheRectificationMaps WRITE setCacheRectificationMaps NOTIFY cacheRectificationMapsChanged)
+    Q_PROPERTY(int minConfidence READ minConfidence WRITE setMinConfidence NOTIFY minConfidenceChanged)
 
 public:
     explicit ZStereoSLS(ZCameraList cameras,
@@ -46,20 +50,35 @@ public:
     ~ZStereoSLS() override;
 
     double maxValidDistance() const;
+    int matchingMethod() const;
+    bool organizedOutput() const;
+    bool cacheRectificationMaps() const;
+    int minConfidence() const;
 
 signals:
     void maxValidDistanceChanged(double maxValidDistance);
+    void matchingMethodChanged(int matchingMethod);
+    void organizedOutputChanged(bool organizedOutput);
+    void cacheRectificationMapsChanged(bool cacheRectificationMaps);
+    void minConfidenceChanged(int minConfidence);
 
 public slots:
     bool setMaxValidDistance(double maxValidDistance);
+    bool setMatchingMethod(int matchingMethod);
+    bool setOrganizedOutput(bool organizedOutput);
+    bool setCacheRectificationMaps(bool cacheRectificationMaps);
+    bool setMinConfidence(int minConfidence);
 
 protected slots:
     Z3D::ZPointCloudPtr triangulate(const cv::Mat &colorImg,
                                     const cv::Mat &leftDecodedImage,
-                                    const cv::Mat &rightDecodedImage);
+                                    const cv::Mat &rightDecodedImage,
+                                    const cv::Rect &leftRoi = cv::Rect(),
+                                    const cv::Rect &rightRoi = cv::Rect(),
+                                    uint64_t rightDecodedImageId = 0);
 
 private:
-    double m_maxValidDistance;
+    int m_minConfidence;
     ZStereoSystemImpl *m_stereoSystem;
 };
 
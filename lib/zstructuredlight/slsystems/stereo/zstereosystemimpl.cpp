@@ -20,16 +20,27 @@
 
 #include "zstereosystemimpl.h"
 
+#include "zcoderowindex.h"
 #include "zdecodedpattern.h"
 #include "zgeometryutils.h"
+#include "zparallelutils.h"
 #include "zpinhole/zopencvstereocameracalibration.h"
 #include "zpinhole/zpinholecameracalibration.h"
+#include "zsimdutils.h"
 #include "zsimplepointcloud.h"
 
 #include <QAtomicInt>
+#include <QCryptographicHash>
+#include <QDataStream>
 #include <QDateTime>
 #include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
 #include <QFuture>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QTime>
 #include <QtConcurrentMap>
 #include <QtConcurrentRun>
 
@@ -37,13 +48,23 @@
 #include <opencv2/imgproc.hpp>
 #include <opencv2/calib3d.hpp>
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
 namespace Z3D
 {
 
 ZStereoSystemImpl::ZStereoSystemImpl(ZMultiCameraCalibrationPtr stereoCalibration, QObject *parent)
     : QObject(parent)
     , m_calibration(std::dynamic_pointer_cast<ZOpenCVStereoCameraCalibration>(stereoCalibration))
+    , m_rayTriangulator(stereoCalibration->calibrations())
+    , m_lightPlanesDecodedImageId(0)
     , m_ready(false)
+    , m_diskCacheEnabled(true)
+    , m_matchingMethod(SortedIndexMatching)
+    , m_maxValidDistance(0.5)
+    , m_organizedOutput(false)
 {
     m_R.resize(2);
     m_P.resize(2);
@@ -63,6 +84,46 @@ bool ZStereoSystemImpl::ready() const
     return m_ready;
 }
 
+bool ZStereoSystemImpl::diskCacheEnabled() const
+{
+    return m_diskCacheEnabled;
+}
+
+void ZStereoSystemImpl::setDiskCacheEnabled(bool enabled)
+{
+    m_diskCacheEnabled = enabled;
+}
+
+ZStereoSystemImpl::MatchingMethod ZStereoSystemImpl::matchingMethod() const
+{
+    return m_matchingMethod;
+}
+
+void ZStereoSystemImpl::setMatchingMethod(MatchingMethod method)
+{
+    m_matchingMethod = method;
+}
+
+double ZStereoSystemImpl::maxValidDistance() const
+{
+    return m_maxValidDistance;
+}
+
+void ZStereoSystemImpl::setMaxValidDistance(double distance)
+{
+    m_maxValidDistance = distance;
+}
+
+bool ZStereoSystemImpl::organizedOutput() const
+{
+    return m_organizedOutput;
+}
+
+void ZStereoSystemImpl::setOrganizedOutput(bool organized)
+{
+    m_organizedOutput = organized;
+}
+
 void ZStereoSystemImpl::stereoRectify(double alpha)
 {
     qDebug() << Q_FUNC_INFO;
@@ -90,26 +151,260 @@ void ZStereoSystemImpl::stereoRectify(double alpha)
                       alpha,
                       m_imageSize, &validRoi[0], &validRoi[1]);
 
+    updateRectificationMaps();
+
     setReady(true);
 }
 
-template<typename T>
-ZPointCloudPtr process(const cv::Mat &colorImg, cv::Mat Q, cv::Mat leftImg, cv::Mat rightImg) {
-    const cv::Size &imgSize = leftImg.size();
-    const int &imgHeight = imgSize.height;
-    const int &imgWidth = imgSize.width;
+namespace
+{
+
+/// increase if the file format (or the way the maps are computed) changes
+constexpr qint32 RECTIFY_MAPS_FORMAT_VERSION = 1;
+constexpr quint32 RECTIFY_MAPS_MAGIC = 0x5a524d50; // "ZRMP"
+
+void addToHash(QCryptographicHash &hash, const cv::Mat &mat)
+{
+    /// always hash the same representation, independently of the original type
+    cv::Mat mat64;
+    mat.convertTo(mat64, CV_64F);
+    mat64 = mat64.reshape(1, 1).clone();
+    hash.addData(reinterpret_cast<const char *>(mat64.data), int(mat64.total() * mat64.elemSize()));
+}
+
+} // anonymous namespace
+
+void ZStereoSystemImpl::updateRectificationMaps()
+{
+    const QByteArray key = rectificationMapsKey();
+    if (key == m_rectifyMapsKey) {
+        qDebug() << "rectification maps didn't change, nothing to do";
+        return;
+    }
+
+    QTime time;
+    time.start();
+
+    if (m_diskCacheEnabled && loadRectificationMaps(key)) {
+        qDebug() << "rectification maps loaded from cache in" << time.elapsed() << "msecs";
+    } else {
+        for (size_t k = 0; k < 2; k++) {
+            cv::initUndistortRectifyMap(m_calibration->cameraMatrix[k], m_calibration->distCoeffs[k], m_R[k], m_P[k], m_imageSize, CV_16SC2, m_rectifyMaps[k][0], m_rectifyMaps[k][1]);
+        }
+        qDebug() << "rectification maps computed in" << time.elapsed() << "msecs";
+
+        if (m_diskCacheEnabled && !saveRectificationMaps(key)) {
+            qWarning() << "unable to save rectification maps to cache";
+        }
+    }
+
+    m_rectifyMapsKey = key;
+}
+
+QByteArray ZStereoSystemImpl::rectificationMapsKey() const
+{
+    /// the maps depend only on the camera intrinsics and the rectification
+    /// transforms (which include the calibration extrinsics and alpha)
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    const qint32 header[] = { RECTIFY_MAPS_FORMAT_VERSION, m_imageSize.width, m_imageSize.height };
+    hash.addData(reinterpret_cast<const char *>(header), sizeof(header));
+    for (size_t k = 0; k < 2; k++) {
+        addToHash(hash, m_calibration->cameraMatrix[k]);
+        addToHash(hash, m_calibration->distCoeffs[k]);
+        addToHash(hash, m_R[k]);
+        addToHash(hash, m_P[k]);
+    }
+    return hash.result().toHex();
+}
+
+QString ZStereoSystemImpl::rectificationMapsCacheFile(const QByteArray &key) const
+{
+    const QString cacheFolder = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+    return QString("%1/rectification/%2.bin").arg(cacheFolder).arg(QString::fromLatin1(key));
+}
+
+bool ZStereoSystemImpl::loadRectificationMaps(const QByteArray &key)
+{
+    QFile file(rectificationMapsCacheFile(key));
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QDataStream stream(&file);
+    quint32 magic;
+    qint32 version, width, height;
+    stream >> magic >> version >> width >> height;
+    if (stream.status() != QDataStream::Ok
+            || magic != RECTIFY_MAPS_MAGIC
+            || version != RECTIFY_MAPS_FORMAT_VERSION
+            || width != m_imageSize.width
+            || height != m_imageSize.height) {
+        qWarning() << "invalid rectification maps cache file" << file.fileName();
+        return false;
+    }
+
+    cv::Mat maps[2][2];
+    for (size_t k = 0; k < 2; k++) {
+        maps[k][0].create(m_imageSize, CV_16SC2);
+        maps[k][1].create(m_imageSize, CV_16UC1);
+        for (auto &map : maps[k]) {
+            const int size = int(map.total() * map.elemSize());
+            if (stream.readRawData(reinterpret_cast<char *>(map.data), size) != size) {
+                qWarning() << "incomplete rectification maps cache file" << file.fileName();
+                return false;
+            }
+        }
+    }
+
+    for (size_t k = 0; k < 2; k++) {
+        m_rectifyMaps[k][0] = maps[k][0];
+        m_rectifyMaps[k][1] = maps[k][1];
+    }
+
+    return true;
+}
+
+bool ZStereoSystemImpl::saveRectificationMaps(const QByteArray &key) const
+{
+    const QString fileName = rectificationMapsCacheFile(key);
+    if (!QDir().mkpath(QFileInfo(fileName).absolutePath())) {
+        return false;
+    }
+
+    /// QSaveFile only replaces the file when everything was written, we never
+    /// leave a half written cache
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+
+    QDataStream stream(&file);
+    stream << RECTIFY_MAPS_MAGIC << RECTIFY_MAPS_FORMAT_VERSION << qint32(m_imageSize.width) << qint32(m_imageSize.height);
+    for (size_t k = 0; k < 2; k++) {
+        for (const auto &map : m_rectifyMaps[k]) {
+            /// maps created by initUndistortRectifyMap are always continuous
+            const int size = int(map.total() * map.elemSize());
+            if (stream.writeRawData(reinterpret_cast<const char *>(map.data), size) != size) {
+                file.cancelWriting();
+                return false;
+            }
+        }
+    }
+
+    return file.commit();
+}
+
+/// Replaces every (x, y, disparity, color) with (X, Y, Z, color) using the Q
+/// matrix, in place. Points that can't be reprojected (i.e. zero disparity, or
+/// NaN input) are removed, or set to NaN if keepInvalid is true (to keep the
+/// layout of organized clouds). Returns the number of points left at the beginning
+typedef size_t (*ReprojectFunc)(ZSimplePointCloud::PointType *points, size_t count, const cv::Matx44f &Q, bool keepInvalid);
+
+size_t reprojectPointsScalar(ZSimplePointCloud::PointType *points, size_t count, const cv::Matx44f &Q, bool keepInvalid)
+{
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+
+    size_t validCount = 0;
+    for (size_t i=0; i<count; ++i) {
+        const ZSimplePointCloud::PointType &point = points[i];
+        const float x = point[0];
+        const float y = point[1];
+        const float d = point[2];
+
+        const float w = 1.f / (Q(3,0)*x + Q(3,1)*y + Q(3,2)*d + Q(3,3));
+        const float X = (Q(0,0)*x + Q(0,1)*y + Q(0,2)*d + Q(0,3)) * w;
+        const float Y = (Q(1,0)*x + Q(1,1)*y + Q(1,2)*d + Q(1,3)) * w;
+        const float Z = (Q(2,0)*x + Q(2,1)*y + Q(2,2)*d + Q(2,3)) * w;
+
+        if (!std::isfinite(X) || !std::isfinite(Y) || !std::isfinite(Z)) {
+            if (keepInvalid) {
+                points[validCount++] = ZSimplePointCloud::PointType(nan, nan, nan, point[3]);
+            }
+            continue;
+        }
+
+        points[validCount++] = ZSimplePointCloud::PointType(X, Y, Z, point[3]);
+    }
+
+    return validCount;
+}
+
+#if defined(Z3D_SIMD_X86)
+
+Z3D_TARGET_SSE41
+size_t reprojectPointsSSE41(ZSimplePointCloud::PointType *points, size_t count, const cv::Matx44f &Q, bool keepInvalid)
+{
+    /// every point fits in a register, (X, Y, Z, W) = x*Q0 + y*Q1 + d*Q2 + Q3
+    /// where Qn is the n-th column of Q
+    const __m128 q0 = _mm_setr_ps(Q(0,0), Q(1,0), Q(2,0), Q(3,0));
+    const __m128 q1 = _mm_setr_ps(Q(0,1), Q(1,1), Q(2,1), Q(3,1));
+    const __m128 q2 = _mm_setr_ps(Q(0,2), Q(1,2), Q(2,2), Q(3,2));
+    const __m128 q3 = _mm_setr_ps(Q(0,3), Q(1,3), Q(2,3), Q(3,3));
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 nan = _mm_set1_ps(std::numeric_limits<float>::quiet_NaN());
+
+    float *data = reinterpret_cast<float *>(points);
+
+    size_t validCount = 0;
+    for (size_t i=0; i<count; ++i) {
+        const __m128 point = _mm_loadu_ps(data + 4*i);
+
+        __m128 result = _mm_add_ps(_mm_mul_ps(_mm_shuffle_ps(point, point, _MM_SHUFFLE(0,0,0,0)), q0), q3);
+        result = _mm_add_ps(result, _mm_mul_ps(_mm_shuffle_ps(point, point, _MM_SHUFFLE(1,1,1,1)), q1));
+        result = _mm_add_ps(result, _mm_mul_ps(_mm_shuffle_ps(point, point, _MM_SHUFFLE(2,2,2,2)), q2));
+        result = _mm_div_ps(result, _mm_shuffle_ps(result, result, _MM_SHUFFLE(3,3,3,3)));
+
+        /// v - v is 0 for finite values, NaN for inf/NaN
+        const bool isValid = (_mm_movemask_ps(_mm_cmpeq_ps(_mm_sub_ps(result, result), zero)) & 0x7) == 0x7;
+        if (!isValid) {
+            result = nan;
+        }
+
+        /// keep the color, always store and only advance if it was valid
+        _mm_storeu_ps(data + 4*validCount, _mm_blend_ps(result, point, 0x8));
+        validCount += isValid || keepInvalid ? 1 : 0;
+    }
 
-    std::vector<cv::Vec3f> disparity;
-    disparity.reserve(size_t(imgHeight * imgWidth)); /// reserve maximum possible size
-    std::vector<uint32_t> color;
+    return validCount;
+}
 
-    for (int y=0; y<imgHeight; ++y) {
+#endif // Z3D_SIMD_X86
+
+ReprojectFunc reprojectPointsKernel()
+{
+    static const ReprojectFunc kernel = []() -> ReprojectFunc {
+#if defined(Z3D_SIMD_X86)
+        if (SimdUtils::bestSupportedLevel() >= SimdUtils::SimdSSE41) {
+            return &reprojectPointsSSE41;
+        }
+#endif
+        return &reprojectPointsScalar;
+    }();
+
+    return kernel;
+}
+
+/// finds the correspondences for rows [rowBegin, rowEnd) and appends them to
+/// points as (x, y, disparity, color), in the same order as the rows/columns.
+/// Scans left and right rows at the same time, so codes must be increasing
+void matchRows(const cv::Mat &colorImg, const cv::Mat &leftImg, const cv::Mat &rightImg,
+               int rowBegin, int rowEnd,
+               ZSimplePointCloud::PointVector &points)
+{
+    const int &imgWidth = leftImg.cols;
+    const int &rightImgWidth = rightImg.cols;
+
+    /// fixed point rows are converted here, one at a time
+    std::vector<float> leftRow;
+    std::vector<float> rightRow;
+
+    for (int y=rowBegin; y<rowEnd; ++y) {
 //        qDebug() << "processing row" << y;
 
         const uint8_t* colorData = colorImg.ptr<uint8_t>(y);
-        T* imgData = leftImg.ptr<T>(y);
-        T* rImgData = rightImg.ptr<T>(y);
-        T* rImgDataNext = rImgData + 1;
+        const float* imgData = ZDecodedPattern::codeRow(leftImg, y, 0, imgWidth, leftRow);
+        const float* rImgData = ZDecodedPattern::codeRow(rightImg, y, 0, rightImgWidth, rightRow);
+        const float* rImgDataNext = rImgData + 1;
         for (int x=0, rx=0; x<imgWidth; ++x, ++imgData, ++colorData) {
             if (*imgData == ZDecodedPattern::NO_VALUE) {
 //                qDebug() << "skipping pixel, no data for left image";
@@ -119,7 +414,7 @@ ZPointCloudPtr process(const cv::Mat &colorImg, cv::Mat Q, cv::Mat leftImg, cv::
 //            qDebug() << "processing col" << x << "value" << *imgData;
 
             bool shouldContinueInRight = true;
-            for (; shouldContinueInRight && rx<imgWidth-1; ++rx, ++rImgData, ++rImgDataNext) {
+            for (; shouldContinueInRight && rx<rightImgWidth-1; ++rx, ++rImgData, ++rImgDataNext) {
                 if (*rImgData == ZDecodedPattern::NO_VALUE) {
 //                    qDebug() << "skipping pixel, no data for right image";
                     continue;
@@ -140,13 +435,7 @@ ZPointCloudPtr process(const cv::Mat &colorImg, cv::Mat Q, cv::Mat leftImg, cv::
                     const float offset = range > FLT_EPSILON
                             ? (*imgData - *rImgData) / range
                             : 0;
-                    disparity.push_back(cv::Vec3f(x, y, float(x) - (float(rx) + offset)));
-
-                    const uint32_t rgbWhite = (static_cast<uint32_t>(*colorData) << 24 | // alpha
-                                               static_cast<uint32_t>(*colorData) << 16 | // r
-                                               static_cast<uint32_t>(*colorData) <<  8 | // g
-                                               static_cast<uint32_t>(*colorData));       // b
-                    color.push_back(rgbWhite);
+                    points.push_back(ZSimplePointCloud::PointType(x, y, float(x) - (float(rx) + offset), ZSimplePointCloud::grayToPackedColor(*colorData)));
 
                     shouldContinueInRight = false;
                     break;
@@ -154,53 +443,255 @@ ZPointCloudPtr process(const cv::Mat &colorImg, cv::Mat Q, cv::Mat leftImg, cv::
             }
         }
     }
+}
 
-    qDebug() << "found" << disparity.size() << "matches";
+/// finds the correspondences for rows [rowBegin, rowEnd) using a sorted index
+/// of the right row codes (see ZCodeRowIndex), so every left pixel gets a
+/// sub-pixel code that is looked up in the right row by binary search
+void matchRowsSortedIndex(const cv::Mat &colorImg, const cv::Mat &leftImg, const cv::Mat &rightImg,
+                          int rowBegin, int rowEnd,
+                          ZSimplePointCloud::PointVector &points)
+{
+    const int &imgWidth = leftImg.cols;
+    const int &rightImgWidth = rightImg.cols;
 
-    if (disparity.size() < 1) {
-         return nullptr;
+    ZCodeRowIndex rightIndex;
+    std::vector<float> leftCodes(size_t(imgWidth));
+    std::vector<float> leftRow;
+    std::vector<float> rightRow;
+
+    for (int y=rowBegin; y<rowEnd; ++y) {
+        const uint8_t* colorData = colorImg.ptr<uint8_t>(y);
+
+        rightIndex.build(ZDecodedPattern::codeRow(rightImg, y, 0, rightImgWidth, rightRow), rightImgWidth);
+        if (rightIndex.empty()) {
+            continue;
+        }
+
+        ZCodeRowIndex::subPixelCodes(ZDecodedPattern::codeRow(leftImg, y, 0, imgWidth, leftRow), imgWidth, leftCodes.data());
+        for (int x=0; x<imgWidth; ++x) {
+            const float code = leftCodes[size_t(x)];
+            float rx;
+            if (std::isnan(code) || !rightIndex.findColumn(code, &rx)) {
+                continue;
+            }
+
+            points.push_back(ZSimplePointCloud::PointType(x, y, float(x) - rx, ZSimplePointCloud::grayToPackedColor(colorData[x])));
+        }
     }
+}
+
+/// leftImg and rightImg are the regions leftRect and rightRect of the
+/// rectified images (same rows), the cloud uses the coordinates of the whole
+/// rectified image (of size imageSize). Both can be floating or fixed point
+ZPointCloudPtr process(const cv::Mat &colorImg, cv::Mat Q, cv::Mat leftImg, cv::Mat rightImg,
+                       const cv::Rect &leftRect, const cv::Rect &rightRect, const cv::Size &imageSize,
+                       ZStereoSystemImpl::MatchingMethod matchingMethod, bool organized) {
+    const int &regionRows = leftImg.rows;
+    const int &imgWidth = imageSize.width;
+
+    /// matches are found in region coordinates
+    const bool hasOffset = leftRect.tl() != cv::Point() || rightRect.x != 0;
+    const float disparityOffset = float(leftRect.x - rightRect.x);
+
+    /// rows are independent after rectification, so they are matched in
+    /// parallel by bands. Every band has its own buffers, and they are joined
+    /// in order at the end, so the result is the same as doing it sequentially
+    constexpr int bandRows = 16;
+    const int bandCount = (regionRows + bandRows - 1) / bandRows;
+
+    /// every band is matched and reprojected in its own buffer, so
+    /// everything is done without intermediate copies of the whole image
+    std::vector<ZSimplePointCloud::PointVector> bandPoints(size_t(bandCount));
+
+    const cv::Matx44f Qf = Q;
+    const ReprojectFunc reprojectPoints = reprojectPointsKernel();
+
+    /// organized clouds have one point per (rectified) pixel, NaN if invalid
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    ZSimplePointCloud::PointVector grid;
+    if (organized) {
+        grid.assign(size_t(imgWidth) * size_t(imageSize.height), ZSimplePointCloud::PointType(nan, nan, nan, 0.f));
+    }
+
+    ParallelUtils::forEachTile(bandCount, [&](int band) {
+        const int rowBegin = band * bandRows;
+        const int rowEnd = std::min(rowBegin + bandRows, regionRows);
+        auto &points = bandPoints[size_t(band)];
+        switch (matchingMethod) {
+        case ZStereoSystemImpl::LinearScanMatching:
+            matchRows(colorImg, leftImg, rightImg, rowBegin, rowEnd, points);
+            break;
+        case ZStereoSystemImpl::SortedIndexMatching:
+            matchRowsSortedIndex(colorImg, leftImg, rightImg, rowBegin, rowEnd, points);
+            break;
+        case ZStereoSystemImpl::RayIntersectionMatching:
+        case ZStereoSystemImpl::LightPlaneMatching:
+            /// doesn't use the rectified images
+            break;
+        }
 
-    std::vector<cv::Vec3f> points3f;
-    cv::perspectiveTransform(disparity, points3f, Q);
+        if (hasOffset) {
+            for (auto &point : points) {
+                point[0] += float(leftRect.x);
+                point[1] += float(leftRect.y);
+                point[2] += disparityOffset;
+            }
+        }
+
+        if (!organized) {
+            points.resize(reprojectPoints(points.data(), points.size(), Qf, false));
+            return;
+        }
+
+        /// move the matches to their pixel and reproject the whole band of
+        /// the grid, keeping invalid pixels as NaN (rows outside the region
+        /// are already NaN)
+        for (const auto &point : points) {
+            grid[size_t(point[1]) * size_t(imgWidth) + size_t(point[0])] = point;
+        }
+        ZSimplePointCloud::PointVector().swap(points);
+        const size_t bandBegin = size_t(leftRect.y + rowBegin) * size_t(imgWidth);
+        reprojectPoints(grid.data() + bandBegin, size_t(rowEnd - rowBegin) * size_t(imgWidth), Qf, true);
+    });
+
+    if (organized) {
+        auto cloud = new ZSimplePointCloud(std::move(grid), unsigned(imgWidth), unsigned(imageSize.height));
+        qDebug() << "found" << cloud->validPointCount() << "valid matches";
+        if (cloud->validPointCount() < 1) {
+            delete cloud;
+            return nullptr;
+        }
+        return ZPointCloudPtr(cloud);
+    }
+
+    size_t pointCount = 0;
+    for (const auto &points : bandPoints) {
+        pointCount += points.size();
+    }
+
+    qDebug() << "found" << pointCount << "valid matches";
+
+    if (pointCount < 1) {
+         return nullptr;
+    }
 
     ZSimplePointCloud::PointVector points;
-    points.resize(points3f.size());
+    points.reserve(pointCount);
+    for (auto &band : bandPoints) {
+        points.insert(points.end(), band.cbegin(), band.cend());
+        ZSimplePointCloud::PointVector().swap(band);
+    }
 
-    for (size_t i=0; i<points.size(); ++i) {
-        points[i][0] = points3f[i][0];
-        points[i][1] = points3f[i][1];
-        points[i][2] = points3f[i][2];
+    return ZPointCloudPtr(new ZSimplePointCloud(std::move(points)));
+}
+
+cv::Rect ZStereoSystemImpl::rectifiedRoi(size_t camera, const cv::Rect &roi) const
+{
+    const cv::Rect imageRect(cv::Point(), m_imageSize);
+    if (roi.empty() || roi == imageRect) {
+        return imageRect;
+    }
 
-        points[i][3] = *reinterpret_cast<const float_t*>(&color[i]);
+    /// the borders are not straight lines after removing the distortion, so
+    /// several points of each side are used
+    constexpr int samplesPerSide = 16;
+    const float left = float(roi.x);
+    const float top = float(roi.y);
+    const float right = float(roi.x + roi.width - 1);
+    const float bottom = float(roi.y + roi.height - 1);
+    std::vector<cv::Point2f> borderPoints;
+    borderPoints.reserve(4 * samplesPerSide);
+    for (int i=0; i<samplesPerSide; ++i) {
+        const float t = float(i) / samplesPerSide;
+        borderPoints.emplace_back(left + t * (right - left), top);
+        borderPoints.emplace_back(right, top + t * (bottom - top));
+        borderPoints.emplace_back(right - t * (right - left), bottom);
+        borderPoints.emplace_back(left, bottom - t * (bottom - top));
     }
 
-    return ZPointCloudPtr(new ZSimplePointCloud(points));
+    std::vector<cv::Point2f> rectifiedPoints;
+    cv::undistortPoints(borderPoints, rectifiedPoints,
+                        m_calibration->cameraMatrix[camera], m_calibration->distCoeffs[camera],
+                        m_R[camera], m_P[camera]);
+
+    /// a couple of pixels more, for the interpolation
+    constexpr int margin = 2;
+    const cv::Rect rect = cv::boundingRect(rectifiedPoints);
+    return cv::Rect(rect.x - margin, rect.y - margin, rect.width + 2 * margin, rect.height + 2 * margin) & imageRect;
 }
 
-Z3D::ZPointCloudPtr ZStereoSystemImpl::triangulate(const cv::Mat &leftColorImage, const cv::Mat &leftDecodedImage, const cv::Mat &rightDecodedImage)
+Z3D::ZPointCloudPtr ZStereoSystemImpl::triangulate(const cv::Mat &leftColorImage, const cv::Mat &leftDecodedImage, const cv::Mat &rightDecodedImage,
+                                                   const cv::Rect &leftRoi, const cv::Rect &rightRoi,
+                                                   uint64_t rightDecodedImageId)
 {
-    //! TODO compute this once and keep in memory?
-    cv::Mat rmap[2][2];
-    for (size_t k = 0; k < 2; k++) {
-        cv::initUndistortRectifyMap(m_calibration->cameraMatrix[k], m_calibration->distCoeffs[k], m_R[k], m_P[k], m_imageSize, CV_16SC2, rmap[k][0], rmap[k][1]);
+    if (m_matchingMethod == RayIntersectionMatching || m_matchingMethod == LightPlaneMatching) {
+        /// the calibration lookup tables are generated in the background,
+        /// they might not be ready before the first scan
+        if (!m_rayTriangulator.ready() && !m_rayTriangulator.updateRays()) {
+            qWarning() << "camera rays are not available yet";
+            return nullptr;
+        }
     }
 
+    if (m_matchingMethod == LightPlaneMatching) {
+        /// the projector decoded image only changes with the pattern settings,
+        /// and then it gets a new id
+        if (m_lightPlanes.empty()
+                || rightDecodedImageId == 0
+                || rightDecodedImageId != m_lightPlanesDecodedImageId) {
+            m_lightPlanesDecodedImageId = 0;
+            if (!m_lightPlanes.build(m_rayTriangulator.rays(0), m_rayTriangulator.rays(1), rightDecodedImage)) {
+                qWarning() << "could not build the light planes of the projector";
+                return nullptr;
+            }
+            m_lightPlanesDecodedImageId = rightDecodedImageId;
+        }
+
+        return m_lightPlanes.triangulate(leftColorImage, leftDecodedImage, leftRoi, m_organizedOutput);
+    }
+
+    if (m_matchingMethod == RayIntersectionMatching) {
+        const float maxDistance = float(m_maxValidDistance);
+        return m_rayTriangulator.triangulate(0, leftColorImage, leftDecodedImage, leftRoi,
+                                             1, rightDecodedImage, rightRoi,
+                                             maxDistance * maxDistance, m_organizedOutput);
+    }
+
+    /// maps are computed once in stereoRectify
+    const auto &rmap = m_rectifyMaps;
+
+    /// rows are the same in both rectified images, only the ones inside both
+    /// regions can have matches
+    cv::Rect leftRect = rectifiedRoi(0, leftRoi);
+    cv::Rect rightRect = rectifiedRoi(1, rightRoi);
+    const int rowBegin = std::max(leftRect.y, rightRect.y);
+    const int rowEnd = std::min(leftRect.y + leftRect.height, rightRect.y + rightRect.height);
+    if (rowBegin >= rowEnd || leftRect.empty() || rightRect.empty()) {
+        qDebug() << "regions of interest don't overlap, nothing to triangulate";
+        return nullptr;
+    }
+    leftRect.y = rightRect.y = rowBegin;
+    leftRect.height = rightRect.height = rowEnd - rowBegin;
+
     cv::Mat leftColorRemapedImage;
-    cv::remap(leftColorImage, leftColorRemapedImage, rmap[0][0], rmap[0][1], cv::INTER_LINEAR);
+    cv::remap(leftColorImage, leftColorRemapedImage, rmap[0][0](leftRect), rmap[0][1](leftRect), cv::INTER_LINEAR);
     cv::Mat leftRemapedImage;
-    cv::remap(leftDecodedImage, leftRemapedImage, rmap[0][0], rmap[0][1], cv::INTER_LINEAR);
+    cv::remap(leftDecodedImage, leftRemapedImage, rmap[0][0](leftRect), rmap[0][1](leftRect), cv::INTER_LINEAR);
     cv::Mat rightRemapedImage;
-    cv::remap(rightDecodedImage, rightRemapedImage, rmap[1][0], rmap[1][1], cv::INTER_LINEAR);
+    cv::remap(rightDecodedImage, rightRemapedImage, rmap[1][0](rightRect), rmap[1][1](rightRect), cv::INTER_LINEAR);
 
-    switch (leftRemapedImage.type()) {
-    case CV_32FC1: // float_t
-        return process<float_t>(leftColorRemapedImage, m_Q, leftRemapedImage, rightRemapedImage);
-    default:
-        qWarning() << "unkwnown image type:" << leftRemapedImage.type();
+    /// the projector image of a single camera system is always floating point
+    for (const cv::Mat &remapedImage : { leftRemapedImage, rightRemapedImage }) {
+        if (remapedImage.type() != CV_32FC1 && remapedImage.type() != CV_16UC1) {
+            qWarning() << "unkwnown image type:" << remapedImage.type();
+            return nullptr;
+        }
     }
 
-    return nullptr;
+    return process(leftColorRemapedImage, m_Q, leftRemapedImage, rightRemapedImage,
+                   leftRect, rightRect, m_imageSize,
+                   m_matchingMethod, m_organizedOutput);
 }
 
 void ZStereoSystemImpl::setReady(bool arg)
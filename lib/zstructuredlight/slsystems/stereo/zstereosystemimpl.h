@@ -21,13 +21,17 @@
 
 #include "zstructuredlight_fwd.h"
 
+#include "zlightplanetable.h"
 #include "zpointcloud_fwd.h"
+#include "zraytriangulator.h"
 #include <Z3DCameraCalibration>
 
 #include <QObject>
 
 #include <opencv2/core/mat.hpp>
 
+#include <atomic>
+
 namespace Z3D
 {
 
@@ -38,32 +42,93 @@ class ZStereoSystemImpl : public QObject
     Q_PROPERTY(bool ready READ ready WRITE setReady NOTIFY readyChanged)
 
 public:
+    enum MatchingMethod {
+        LinearScanMatching = 0,
+        SortedIndexMatching,
+        RayIntersectionMatching, /// no rectification, see ZRayTriangulator
+        LightPlaneMatching /// camera + projector only, see ZLightPlaneTable
+    };
+    Q_ENUM(MatchingMethod)
+
     explicit ZStereoSystemImpl(ZMultiCameraCalibrationPtr stereoCalibration, QObject *parent = nullptr);
     ~ZStereoSystemImpl();
 
     bool ready() const;
 
+    /// keep the rectification maps on disk, so they don't need to be computed
+    /// again for the same calibration (i.e. after restarting)
+    bool diskCacheEnabled() const;
+    void setDiskCacheEnabled(bool enabled);
+
+    MatchingMethod matchingMethod() const;
+    void setMatchingMethod(MatchingMethod method);
+
+    /// maximum distance between the rays of a match to consider it valid,
+    /// only used by RayIntersectionMatching
+    double maxValidDistance() const;
+    void setMaxValidDistance(double distance);
+
+    /// output width x height clouds (one point per rectified pixel of the
+    /// left camera, NaN if invalid) instead of a list of valid points
+    bool organizedOutput() const;
+    void setOrganizedOutput(bool organized);
+
 signals:
     void readyChanged(bool arg);
 
 public slots:
+    /// leftRoi and rightRoi are the regions of the (original) images that were
+    /// decoded, empty to use the whole image. Only the part of the rectified
+    /// images covered by them is remapped and matched.
+    /// With LightPlaneMatching the right camera is a projector, and its decoded
+    /// image is only used to fit the planes. They are fitted again when
+    /// rightDecodedImageId changes (see ZProjectedPattern), or always if it's 0
     Z3D::ZPointCloudPtr triangulate(const cv::Mat &leftColorImage,
                                     const cv::Mat &leftDecodedImage,
-                                    const cv::Mat &rightDecodedImage);
+                                    const cv::Mat &rightDecodedImage,
+                                    const cv::Rect &leftRoi = cv::Rect(),
+                                    const cv::Rect &rightRoi = cv::Rect(),
+                                    uint64_t rightDecodedImageId = 0);
 
 protected slots:
     void stereoRectify(double alpha = -1);
     void setReady(bool arg);
 
 protected:
+    void updateRectificationMaps();
+    QByteArray rectificationMapsKey() const;
+    QString rectificationMapsCacheFile(const QByteArray &key) const;
+    bool loadRectificationMaps(const QByteArray &key);
+    bool saveRectificationMaps(const QByteArray &key) const;
+    /// bounding box, in the rectified image, of a region of the original image
+    cv::Rect rectifiedRoi(size_t camera, const cv::Rect &roi) const;
+
     ZStereoCameraCalibrationPtr m_calibration;
     cv::Size m_imageSize;
     std::vector<cv::Mat> m_R;
     std::vector<cv::Mat> m_P;
     cv::Mat m_Q;
 
+    /// undistort + rectify maps for each camera, in fixed point format
+    /// (CV_16SC2 integer coordinates + CV_16UC1 interpolation table)
+    cv::Mat m_rectifyMaps[2][2];
+    /// hash of everything used to compute m_rectifyMaps
+    QByteArray m_rectifyMapsKey;
+
+    /// rays of every pixel, built the first time they are needed
+    ZRayTriangulator m_rayTriangulator;
+
+    /// planes of the projector codes, built the first time they are needed
+    ZLightPlaneTable m_lightPlanes;
+    /// id of the projector decoded image used to build m_lightPlanes
+    uint64_t m_lightPlanesDecodedImageId;
+
 private:
     bool m_ready;
+    std::atomic<bool> m_diskCacheEnabled;
+    MatchingMethod m_matchingMethod;
+    double m_maxValidDistance;
+    bool m_organizedOutput;
 };
 
 } // namespace Z3D
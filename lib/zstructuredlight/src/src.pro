@@ -10,13 +10,21 @@ DEFINES      += Z3D_STRUCTUREDLIGHT_LIBRARY
 
 HEADERS += \
     Z3DStructuredLight \
+    zbinarypatterndecoder.h \
     zcameraacquisitionmanager.h \
+    zcoderowindex.h \
     zdecodedpattern.h \
+    zfringepoints.h \
     zgeometryutils.h \
+    zlightplanetable.h \
+    zparallelutils.h \
     zpatternprojection.h \
     zpatternprojectionplugin.h \
     zpatternprojectionprovider.h \
     zprojectedpattern.h \
+    zprojectionutils.h \
+    zraytriangulator.h \
+    zsimdutils.h \
     zsimplepointcloud.h \
     zstructuredlight_fwd.h \
     zstructuredlight_global.h \
@@ -26,13 +34,20 @@ HEADERS += \
     zstructuredlightsystemprovider.h \
 
 SOURCES += \
+    zbinarypatterndecoder.cpp \
     zcameraacquisitionmanager.cpp \
+    zcoderowindex.cpp \
     zdecodedpattern.cpp \
+    zfringepoints.cpp \
     zgeometryutils.cpp \
+    zlightplanetable.cpp \
+    zparallelutils.cpp \
     zpatternprojection.cpp \
     zpatternprojectionplugin.cpp \
     zpatternprojectionprovider.cpp \
     zprojectedpattern.cpp \
+    zprojectionutils.cpp \
+    zraytriangulator.cpp \
     zsimplepointcloud.cpp \
     zstructuredlightpattern.cpp \
     zstructuredlightsystem.cpp \
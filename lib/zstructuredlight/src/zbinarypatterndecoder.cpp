@@ -0,0 +1,696 @@
+//
+// Z3D - A structured light 3D scanner
+// Copyright (C) 2013-2016 Nicolas Ulrich <nikolaseu@gmail.com>
+//
+// This file is part of Z3D.
+//
+// Z3D is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Z3D is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Z3D.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "zbinarypatterndecoder.h"
+
+#include "zdecodedpattern.h"
+#include "zfringepoints.h"
+#include "zsimdutils.h"
+
+#include <algorithm>
+#include <cstring> // memcpy
+
+#include <opencv2/imgproc.hpp>
+
+#include <QDebug>
+
+namespace Z3D
+{
+
+namespace ZBinaryPatternDecoder
+{
+
+constexpr const uint16_t NO_VALUE = std::numeric_limits<uint16_t>::quiet_NaN();
+
+unsigned int binaryToGray(unsigned int num)
+{
+    return (num >> 1) ^ num;
+}
+
+
+unsigned int grayToBinary(unsigned int num)
+{
+    /// every binary bit is the XOR of all the gray bits above it (prefix XOR),
+    /// which can be computed in log2(bits) steps instead of one bit at a time
+    num ^= num >> 16;
+    num ^= num >> 8;
+    num ^= num >> 4;
+    num ^= num >> 2;
+    num ^= num >> 1;
+    return num;
+}
+
+
+namespace
+{
+
+/// Compares every normal/inverted pair of a row and appends the results to the
+/// code words already in codeRow, i.e. code = (code << bitCount) | bits.
+/// The first image is the most significant bit.
+/// confidenceRow keeps the minimum contrast (normal - inverted, in absolute
+/// value) of all the bits, it must be initialized (255 for the first bit).
+/// Pixels outside the mask are set to NO_VALUE and confidence 0.
+typedef void (*PackRowFunc)(const uint8_t * const *rows,
+                            const uint8_t * const *invRows,
+                            int bitCount,
+                            const uint8_t *maskRow,
+                            uint16_t *codeRow,
+                            uint8_t *confidenceRow,
+                            int begin,
+                            int end);
+
+/// Converts the codes of a row to float, setting the pixels outside the mask
+/// to ZDecodedPattern::NO_VALUE.
+/// The gray code variants also convert the codes to binary on the fly
+typedef void (*EmitRowFunc)(const uint16_t *codeRow,
+                            const uint8_t *maskRow,
+                            float *decodedRow,
+                            int begin,
+                            int end);
+
+/// Same as EmitRowFunc for fixed point decoded images, see ZDecodedPattern
+typedef void (*EmitFixedRowFunc)(const uint16_t *codeRow,
+                                 const uint8_t *maskRow,
+                                 uint16_t *decodedRow,
+                                 int begin,
+                                 int end);
+
+/// the fixed point kernels clear invalid pixels with a mask
+static_assert(Z3D::ZDecodedPattern::FIXED_POINT_NO_VALUE == 0, "fixed point NO_VALUE must be 0");
+
+void packRowScalar(const uint8_t * const *rows, const uint8_t * const *invRows, int bitCount, const uint8_t *maskRow, uint16_t *codeRow, uint8_t *confidenceRow, int begin, int end)
+{
+    for (int x=begin; x<end; ++x) {
+        uint16_t value = NO_VALUE;
+        uint8_t confidence = 0;
+        if (maskRow[x]) {
+            value = codeRow[x];
+            confidence = confidenceRow[x];
+            for (int i=0; i<bitCount; ++i) {
+                const uint8_t pixel = rows[i][x];
+                const uint8_t invPixel = invRows[i][x];
+                value = uint16_t(value << 1) | (pixel > invPixel ? 1 : 0);
+                confidence = std::min(confidence, uint8_t(pixel > invPixel ? pixel - invPixel : invPixel - pixel));
+            }
+        }
+        codeRow[x] = value;
+        confidenceRow[x] = confidence;
+    }
+}
+
+/// codes are never more than 16 bits, so 4 steps of the prefix XOR are enough
+inline uint32_t grayToBinary16(uint32_t code)
+{
+    code ^= code >> 8;
+    code ^= code >> 4;
+    code ^= code >> 2;
+    code ^= code >> 1;
+    return code;
+}
+
+template<bool isGrayCode>
+void emitRowScalar(const uint16_t *codeRow, const uint8_t *maskRow, float *decodedRow, int begin, int end)
+{
+    for (int x=begin; x<end; ++x) {
+        const uint32_t code = isGrayCode
+                ? grayToBinary16(codeRow[x])
+                : codeRow[x];
+        decodedRow[x] = maskRow[x]
+                ? float(code)
+                : Z3D::ZDecodedPattern::NO_VALUE;
+    }
+}
+
+template<bool isGrayCode>
+void emitFixedRowScalar(const uint16_t *codeRow, const uint8_t *maskRow, uint16_t *decodedRow, int begin, int end)
+{
+    for (int x=begin; x<end; ++x) {
+        const uint32_t code = isGrayCode
+                ? grayToBinary16(codeRow[x])
+                : codeRow[x];
+        decodedRow[x] = maskRow[x]
+                ? uint16_t((code + 1) << Z3D::ZDecodedPattern::FIXED_POINT_FRACTION_BITS)
+                : Z3D::ZDecodedPattern::FIXED_POINT_NO_VALUE;
+    }
+}
+
+#if defined(Z3D_SIMD_X86)
+
+Z3D_TARGET_SSE41
+void packRowSSE41(const uint8_t * const *rows, const uint8_t * const *invRows, int bitCount, const uint8_t *maskRow, uint16_t *codeRow, uint8_t *confidenceRow, int begin, int end)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i ones = _mm_cmpeq_epi8(zero, zero);
+
+    int x = begin;
+    for (; x + 16 <= end; x += 16) {
+        /// 16 pixels per iteration, two registers of 8 codes each
+        __m128i codeLo = _mm_loadu_si128(reinterpret_cast<const __m128i *>(codeRow + x));
+        __m128i codeHi = _mm_loadu_si128(reinterpret_cast<const __m128i *>(codeRow + x + 8));
+        __m128i confidence = _mm_loadu_si128(reinterpret_cast<const __m128i *>(confidenceRow + x));
+        for (int i=0; i<bitCount; ++i) {
+            const __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i *>(rows[i] + x));
+            const __m128i invValue = _mm_loadu_si128(reinterpret_cast<const __m128i *>(invRows[i] + x));
+            /// value > invValue <=> saturated (value - invValue) != 0
+            const __m128i diff = _mm_subs_epu8(value, invValue);
+            const __m128i isSet = _mm_xor_si128(_mm_cmpeq_epi8(diff, zero), ones);
+            /// only one of the saturated differences can be non zero
+            confidence = _mm_min_epu8(confidence, _mm_or_si128(diff, _mm_subs_epu8(invValue, value)));
+            /// isSet is 0 or -1, so code = 2 * code - isSet appends the new bit
+            codeLo = _mm_sub_epi16(_mm_add_epi16(codeLo, codeLo), _mm_cvtepi8_epi16(isSet));
+            codeHi = _mm_sub_epi16(_mm_add_epi16(codeHi, codeHi), _mm_cvtepi8_epi16(_mm_srli_si128(isSet, 8)));
+        }
+
+        const __m128i valid = _mm_xor_si128(_mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(maskRow + x)), zero), ones);
+        codeLo = _mm_and_si128(codeLo, _mm_cvtepi8_epi16(valid));
+        codeHi = _mm_and_si128(codeHi, _mm_cvtepi8_epi16(_mm_srli_si128(valid, 8)));
+        confidence = _mm_and_si128(confidence, valid);
+
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(codeRow + x), codeLo);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(codeRow + x + 8), codeHi);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(confidenceRow + x), confidence);
+    }
+
+    packRowScalar(rows, invRows, bitCount, maskRow, codeRow, confidenceRow, x, end);
+}
+
+Z3D_TARGET_SSE41
+inline __m128i grayToBinarySSE41(__m128i code)
+{
+    code = _mm_xor_si128(code, _mm_srli_epi32(code, 8));
+    code = _mm_xor_si128(code, _mm_srli_epi32(code, 4));
+    code = _mm_xor_si128(code, _mm_srli_epi32(code, 2));
+    return _mm_xor_si128(code, _mm_srli_epi32(code, 1));
+}
+
+template<bool isGrayCode>
+Z3D_TARGET_SSE41
+void emitRowSSE41(const uint16_t *codeRow, const uint8_t *maskRow, float *decodedRow, int begin, int end)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128 noValue = _mm_set1_ps(Z3D::ZDecodedPattern::NO_VALUE);
+
+    int x = begin;
+    for (; x + 4 <= end; x += 4) {
+        __m128i code = _mm_cvtepu16_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(codeRow + x)));
+        if (isGrayCode) {
+            code = grayToBinarySSE41(code);
+        }
+        int32_t maskBytes;
+        memcpy(&maskBytes, maskRow + x, sizeof(maskBytes));
+        const __m128i invalid = _mm_cmpeq_epi32(_mm_cvtepu8_epi32(_mm_cvtsi32_si128(maskBytes)), zero);
+        const __m128 value = _mm_blendv_ps(_mm_cvtepi32_ps(code), noValue, _mm_castsi128_ps(invalid));
+        _mm_storeu_ps(decodedRow + x, value);
+    }
+
+    emitRowScalar<isGrayCode>(codeRow, maskRow, decodedRow, x, end);
+}
+
+Z3D_TARGET_SSE41
+inline __m128i grayToBinary16SSE41(__m128i code)
+{
+    code = _mm_xor_si128(code, _mm_srli_epi16(code, 8));
+    code = _mm_xor_si128(code, _mm_srli_epi16(code, 4));
+    code = _mm_xor_si128(code, _mm_srli_epi16(code, 2));
+    return _mm_xor_si128(code, _mm_srli_epi16(code, 1));
+}
+
+template<bool isGrayCode>
+Z3D_TARGET_SSE41
+void emitFixedRowSSE41(const uint16_t *codeRow, const uint8_t *maskRow, uint16_t *decodedRow, int begin, int end)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i one = _mm_set1_epi16(1);
+
+    int x = begin;
+    for (; x + 8 <= end; x += 8) {
+        /// codes are already 16 bits, no need to widen them
+        __m128i code = _mm_loadu_si128(reinterpret_cast<const __m128i *>(codeRow + x));
+        if (isGrayCode) {
+            code = grayToBinary16SSE41(code);
+        }
+        const __m128i invalid = _mm_cmpeq_epi16(_mm_cvtepu8_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(maskRow + x))), zero);
+        const __m128i value = _mm_slli_epi16(_mm_add_epi16(code, one), Z3D::ZDecodedPattern::FIXED_POINT_FRACTION_BITS);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(decodedRow + x), _mm_andnot_si128(invalid, value));
+    }
+
+    emitFixedRowScalar<isGrayCode>(codeRow, maskRow, decodedRow, x, end);
+}
+
+Z3D_TARGET_AVX2
+void packRowAVX2(const uint8_t * const *rows, const uint8_t * const *invRows, int bitCount, const uint8_t *maskRow, uint16_t *codeRow, uint8_t *confidenceRow, int begin, int end)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i ones = _mm256_cmpeq_epi8(zero, zero);
+
+    int x = begin;
+    for (; x + 32 <= end; x += 32) {
+        /// 32 pixels per iteration, two registers of 16 codes each
+        __m256i codeLo = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(codeRow + x));
+        __m256i codeHi = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(codeRow + x + 16));
+        __m256i confidence = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(confidenceRow + x));
+        for (int i=0; i<bitCount; ++i) {
+            const __m256i value = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(rows[i] + x));
+            const __m256i invValue = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(invRows[i] + x));
+            const __m256i diff = _mm256_subs_epu8(value, invValue);
+            const __m256i isSet = _mm256_xor_si256(_mm256_cmpeq_epi8(diff, zero), ones);
+            confidence = _mm256_min_epu8(confidence, _mm256_or_si256(diff, _mm256_subs_epu8(invValue, value)));
+            codeLo = _mm256_sub_epi16(_mm256_add_epi16(codeLo, codeLo), _mm256_cvtepi8_epi16(_mm256_castsi256_si128(isSet)));
+            codeHi = _mm256_sub_epi16(_mm256_add_epi16(codeHi, codeHi), _mm256_cvtepi8_epi16(_mm256_extracti128_si256(isSet, 1)));
+        }
+
+        const __m256i valid = _mm256_xor_si256(_mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(maskRow + x)), zero), ones);
+        codeLo = _mm256_and_si256(codeLo, _mm256_cvtepi8_epi16(_mm256_castsi256_si128(valid)));
+        codeHi = _mm256_and_si256(codeHi, _mm256_cvtepi8_epi16(_mm256_extracti128_si256(valid, 1)));
+        confidence = _mm256_and_si256(confidence, valid);
+
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(codeRow + x), codeLo);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(codeRow + x + 16), codeHi);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(confidenceRow + x), confidence);
+    }
+
+    packRowSSE41(rows, invRows, bitCount, maskRow, codeRow, confidenceRow, x, end);
+}
+
+Z3D_TARGET_AVX2
+inline __m256i grayToBinaryAVX2(__m256i code)
+{
+    code = _mm256_xor_si256(code, _mm256_srli_epi32(code, 8));
+    code = _mm256_xor_si256(code, _mm256_srli_epi32(code, 4));
+    code = _mm256_xor_si256(code, _mm256_srli_epi32(code, 2));
+    return _mm256_xor_si256(code, _mm256_srli_epi32(code, 1));
+}
+
+template<bool isGrayCode>
+Z3D_TARGET_AVX2
+void emitRowAVX2(const uint16_t *codeRow, const uint8_t *maskRow, float *decodedRow, int begin, int end)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256 noValue = _mm256_set1_ps(Z3D::ZDecodedPattern::NO_VALUE);
+
+    int x = begin;
+    for (; x + 8 <= end; x += 8) {
+        __m256i code = _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(codeRow + x)));
+        if (isGrayCode) {
+            code = grayToBinaryAVX2(code);
+        }
+        const __m256i invalid = _mm256_cmpeq_epi32(_mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(maskRow + x))), zero);
+        const __m256 value = _mm256_blendv_ps(_mm256_cvtepi32_ps(code), noValue, _mm256_castsi256_ps(invalid));
+        _mm256_storeu_ps(decodedRow + x, value);
+    }
+
+    emitRowSSE41<isGrayCode>(codeRow, maskRow, decodedRow, x, end);
+}
+
+Z3D_TARGET_AVX2
+inline __m256i grayToBinary16AVX2(__m256i code)
+{
+    code = _mm256_xor_si256(code, _mm256_srli_epi16(code, 8));
+    code = _mm256_xor_si256(code, _mm256_srli_epi16(code, 4));
+    code = _mm256_xor_si256(code, _mm256_srli_epi16(code, 2));
+    return _mm256_xor_si256(code, _mm256_srli_epi16(code, 1));
+}
+
+template<bool isGrayCode>
+Z3D_TARGET_AVX2
+void emitFixedRowAVX2(const uint16_t *codeRow, const uint8_t *maskRow, uint16_t *decodedRow, int begin, int end)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i one = _mm256_set1_epi16(1);
+
+    int x = begin;
+    for (; x + 16 <= end; x += 16) {
+        __m256i code = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(codeRow + x));
+        if (isGrayCode) {
+            code = grayToBinary16AVX2(code);
+        }
+        const __m256i invalid = _mm256_cmpeq_epi16(_mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(maskRow + x))), zero);
+        const __m256i value = _mm256_slli_epi16(_mm256_add_epi16(code, one), Z3D::ZDecodedPattern::FIXED_POINT_FRACTION_BITS);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(decodedRow + x), _mm256_andnot_si256(invalid, value));
+    }
+
+    emitFixedRowSSE41<isGrayCode>(codeRow, maskRow, decodedRow, x, end);
+}
+
+#endif // Z3D_SIMD_X86
+
+struct DecoderKernels
+{
+    PackRowFunc packRow;
+    EmitRowFunc emitRow;
+    EmitRowFunc emitGrayRow;
+    EmitFixedRowFunc emitFixedRow;
+    EmitFixedRowFunc emitFixedGrayRow;
+};
+
+const DecoderKernels &decoderKernels()
+{
+    /// selected only once, the first time we decode something
+    static const DecoderKernels kernels = []() {
+        const auto level = SimdUtils::bestSupportedLevel();
+        qDebug() << "binary pattern decoder using" << SimdUtils::levelName(level) << "kernels";
+        switch (level) {
+#if defined(Z3D_SIMD_X86)
+        case SimdUtils::SimdAVX2:
+            return DecoderKernels { &packRowAVX2, &emitRowAVX2<false>, &emitRowAVX2<true>,
+                                    &emitFixedRowAVX2<false>, &emitFixedRowAVX2<true> };
+        case SimdUtils::SimdSSE41:
+            return DecoderKernels { &packRowSSE41, &emitRowSSE41<false>, &emitRowSSE41<true>,
+                                    &emitFixedRowSSE41<false>, &emitFixedRowSSE41<true> };
+#endif
+        default:
+            return DecoderKernels { &packRowScalar, &emitRowScalar<false>, &emitRowScalar<true>,
+                                    &emitFixedRowScalar<false>, &emitFixedRowScalar<true> };
+        }
+    }();
+
+    return kernels;
+}
+
+/// hole filling, gray decoding and conversion to the final values of row y
+/// of decodedImg (floating point or fixed point)
+void finishRow(const DecoderKernels &kernels, uint16_t *codeData, const uint8_t *maskImgData, cv::Mat &decodedImg, int y, int imgWidth, bool isGrayCode)
+{
+    /// fill single pixel holes.
+    /// Gray to binary is a bijection (and keeps NO_VALUE as is), so it's
+    /// the same to do it before or after filling, and doing it after allows
+    /// to convert the codes while writing the final values
+    for (int x=1; x<imgWidth-1; ++x) {
+        uint16_t &value = codeData[x];
+        if (value != NO_VALUE) {
+            continue;
+        }
+
+        const uint16_t valueLeft = codeData[x - 1];
+        const uint16_t valueRight = codeData[x + 1];
+        if (valueLeft != NO_VALUE && valueRight == valueLeft) {
+            /// assign value
+            value = valueLeft;
+        }
+    }
+
+    /// convert gray code to binary (i.e. "normal" value) and write final
+    /// values, empty pixels are set to the corresponding standard value
+    if (decodedImg.type() == CV_16UC1) {
+        const EmitFixedRowFunc emitRow = isGrayCode
+                ? kernels.emitFixedGrayRow
+                : kernels.emitFixedRow;
+        emitRow(codeData, maskImgData, decodedImg.ptr<uint16_t>(y), 0, imgWidth);
+        return;
+    }
+
+    const EmitRowFunc emitRow = isGrayCode
+            ? kernels.emitGrayRow
+            : kernels.emitRow;
+    emitRow(codeData, maskImgData, decodedImg.ptr<float>(y), 0, imgWidth);
+}
+
+} // anonymous namespace
+
+
+cv::Mat decodeBinaryPatternImages(const std::vector<cv::Mat> &images, const std::vector<cv::Mat> &invImages, cv::Mat maskImg, bool isGrayCode, cv::Mat *confidenceImg, const cv::Rect &roi, int decodedType)
+{
+    const cv::Rect imageRect(cv::Point(), images[0].size());
+    const cv::Rect decodeRect = roi.empty()
+            ? imageRect
+            : roi & imageRect;
+
+    /// codes that don't fit in fixed point need floating point
+    if (decodedType == CV_16UC1 && (1 << int(images.size())) - 1 > ZDecodedPattern::FIXED_POINT_MAX_CODE) {
+        decodedType = CV_32FC1;
+    }
+    cv::Mat decodedImg(images[0].size(), decodedType);
+
+    if (confidenceImg) {
+        confidenceImg->create(images[0].size(), CV_8UC1);
+    }
+
+    if (decodeRect == imageRect) {
+        decodeBinaryPatternImageRows(images, invImages, maskImg, isGrayCode, decodedImg, 0, decodedImg.rows,
+                                     confidenceImg ? *confidenceImg : cv::Mat());
+        return decodedImg;
+    }
+
+    /// only the region of interest is decoded, the rest is left empty
+    decodedImg.setTo(ZDecodedPattern::noValue(decodedType));
+    if (confidenceImg) {
+        confidenceImg->setTo(0);
+    }
+
+    if (decodeRect.empty()) {
+        return decodedImg;
+    }
+
+    std::vector<cv::Mat> roiImages;
+    std::vector<cv::Mat> roiInvImages;
+    for (size_t i=0; i<images.size(); ++i) {
+        roiImages.push_back(images[i](decodeRect));
+        roiInvImages.push_back(invImages[i](decodeRect));
+    }
+
+    decodeBinaryPatternImageRows(roiImages, roiInvImages, maskImg(decodeRect), isGrayCode, decodedImg(decodeRect), 0, decodeRect.height,
+                                 confidenceImg ? (*confidenceImg)(decodeRect) : cv::Mat());
+
+    return decodedImg;
+}
+
+
+void decodeBinaryPatternImageRows(const std::vector<cv::Mat> &images, const std::vector<cv::Mat> &invImages, cv::Mat maskImg, bool isGrayCode, cv::Mat decodedImg, int rowBegin, int rowEnd, cv::Mat confidenceImg)
+{
+    const size_t imgCount = images.size();
+
+    const int imgWidth = images[0].cols;
+
+    const DecoderKernels &kernels = decoderKernels();
+
+    /// everything is done in a single sweep, one row at a time. We only need
+    /// a row of codes (16 bits is more than enough), it stays in cache
+    std::vector<uint16_t> codeRow(imgWidth);
+    /// the confidence is computed anyway, it's free while comparing the pairs
+    std::vector<uint8_t> confidenceScratch(confidenceImg.empty() ? imgWidth : 0);
+    std::vector<const uint8_t*> rows(imgCount);
+    std::vector<const uint8_t*> invRows(imgCount);
+
+    for (int y=rowBegin; y<rowEnd; ++y) {
+        /// get pointers to first item of the row, for every image
+        for (size_t i=0; i<imgCount; ++i) {
+            rows[i] = images[i].ptr<uint8_t>(y);
+            invRows[i] = invImages[i].ptr<uint8_t>(y);
+        }
+        const uint8_t* maskImgData = maskImg.ptr<uint8_t>(y);
+        uint16_t* codeData = codeRow.data();
+        std::fill(codeRow.begin(), codeRow.end(), NO_VALUE);
+        uint8_t* confidenceData = confidenceImg.empty()
+                ? confidenceScratch.data()
+                : confidenceImg.ptr<uint8_t>(y);
+        std::fill(confidenceData, confidenceData + imgWidth, std::numeric_limits<uint8_t>::max());
+
+        /// compare all the normal/inverted pairs and pack the bits
+        kernels.packRow(rows.data(), invRows.data(), int(imgCount), maskImgData, codeData, confidenceData, 0, imgWidth);
+
+        finishRow(kernels, codeData, maskImgData, decodedImg, y, imgWidth, isGrayCode);
+    }
+}
+
+
+void accumulateBinaryPatternImage(const cv::Mat &image, const cv::Mat &invImage, cv::Mat maskImg, cv::Mat &codeImg, cv::Mat &confidenceImg)
+{
+    const cv::Size &imgSize = image.size();
+
+    const int &imgHeight = imgSize.height;
+    const int &imgWidth = imgSize.width;
+
+    if (codeImg.size() != imgSize || codeImg.type() != CV_16UC1) {
+        codeImg = cv::Mat(imgSize, CV_16UC1, cv::Scalar(NO_VALUE));
+    }
+
+    if (confidenceImg.size() != imgSize || confidenceImg.type() != CV_8UC1) {
+        confidenceImg = cv::Mat(imgSize, CV_8UC1, cv::Scalar(std::numeric_limits<uint8_t>::max()));
+    }
+
+    const DecoderKernels &kernels = decoderKernels();
+
+    for (int y=0; y<imgHeight; ++y) {
+        const uint8_t* imgData = image.ptr<uint8_t>(y);
+        const uint8_t* invImgData = invImage.ptr<uint8_t>(y);
+
+        /// append the bit to the codes we already have
+        kernels.packRow(&imgData, &invImgData, 1, maskImg.ptr<uint8_t>(y), codeImg.ptr<uint16_t>(y), confidenceImg.ptr<uint8_t>(y), 0, imgWidth);
+    }
+}
+
+
+cv::Mat finishBinaryPatternDecoding(cv::Mat codeImg, cv::Mat maskImg, bool isGrayCode, int decodedType)
+{
+    cv::Mat decodedImg(codeImg.size(), decodedType);
+
+    finishBinaryPatternDecodingRows(codeImg, maskImg, isGrayCode, decodedImg, 0, decodedImg.rows);
+
+    return decodedImg;
+}
+
+
+void finishBinaryPatternDecodingRows(cv::Mat codeImg, cv::Mat maskImg, bool isGrayCode, cv::Mat decodedImg, int rowBegin, int rowEnd)
+{
+    const int imgWidth = codeImg.cols;
+
+    const DecoderKernels &kernels = decoderKernels();
+
+    /// codeImg is modified in place, it's not needed after this
+    for (int y=rowBegin; y<rowEnd; ++y) {
+        finishRow(kernels, codeImg.ptr<uint16_t>(y), maskImg.ptr<uint8_t>(y), decodedImg, y, imgWidth, isGrayCode);
+    }
+}
+
+
+cv::Mat referenceMaskImage(const cv::Mat &whiteImg, const cv::Mat &blackImg, int noiseThreshold, cv::Rect &roi, bool fitToMask)
+{
+    const cv::Rect imageRect(cv::Point(), whiteImg.size());
+    roi = roi.empty()
+            ? imageRect
+            : roi & imageRect;
+
+    if (roi.empty()) {
+        return cv::Mat();
+    }
+
+    /// set mask to keep only values greater than threshold
+    cv::Mat maskImg = (whiteImg(roi) - blackImg(roi)) > noiseThreshold;
+
+    if (fitToMask) {
+        const cv::Rect maskRect = cv::boundingRect(maskImg);
+        roi = cv::Rect(roi.tl() + maskRect.tl(), maskRect.size());
+        maskImg = maskRect.empty()
+                ? cv::Mat()
+                : maskImg(maskRect);
+    }
+
+    return maskImg;
+}
+
+
+cv::Mat binaryThresholdImage(const cv::Mat &whiteImg, const cv::Mat &blackImg)
+{
+    cv::Mat thresholdImg;
+    cv::addWeighted(whiteImg, 0.5, blackImg, 0.5, 0., thresholdImg);
+    return thresholdImg;
+}
+
+
+cv::Mat simplifyBinaryPatternData(cv::Mat image, const std::vector<cv::Mat> &images, const std::vector<cv::Mat> &invImages, cv::Mat maskImg, bool isGrayCode, ZFringePoints &fringePoints)
+{
+    if (image.type() == CV_16UC1) {
+        ZDecodedPattern::convertDecodedImage(image, image, CV_32FC1);
+    }
+
+    const cv::Size &imgSize = image.size();
+
+    /// use 16 bits, it's enough
+    cv::Mat decodedImg(imgSize, CV_16U, cv::Scalar(0));
+
+    const int &imgHeight = imgSize.height;
+    const int &imgWidth = imgSize.width;
+    const int bitCount = int(images.size());
+
+    /// calls func(x, y, value, nextValue) for every border, i.e. every pair of
+    /// horizontally adjacent valid pixels with different codes
+    const auto forEachBorder = [&](const auto &func) {
+        for (int y=0; y<imgHeight; ++y) {
+            const uint8_t* maskImgData = maskImg.ptr<uint8_t>(y);
+            const float* imgData = image.ptr<float>(y);
+            for (int x=0; x<imgWidth-1; ++x) {
+                if (!maskImgData[x] || !maskImgData[x+1]) {
+                    continue;
+                }
+
+                const uint16_t value = uint16_t(imgData[x]);
+                const uint16_t nextValue = uint16_t(imgData[x+1]);
+                if (nextValue != value) {
+                    func(x, y, value, nextValue);
+                }
+            }
+        }
+    };
+
+    /// first count the points of every fringe, so all of them can be stored
+    /// in a single allocation. Points are only added to the fringe at each
+    /// side of the border, using the left border of each one
+    std::vector<size_t> pointsPerCode;
+    const auto countPoint = [&](uint16_t code) {
+        if (code >= pointsPerCode.size()) {
+            pointsPerCode.resize(size_t(code) + 1, 0);
+        }
+        ++pointsPerCode[code];
+    };
+    forEachBorder([&](int, int, uint16_t value, uint16_t nextValue) {
+        const uint16_t imin = std::min(value, nextValue);
+        const uint16_t imax = std::max(value, nextValue);
+        countPoint(imin);
+        if (imax - imin > 1) {
+            countPoint(imax - 1);
+        }
+    });
+
+    fringePoints.allocate(pointsPerCode);
+
+    forEachBorder([&](int x, int y, uint16_t value, uint16_t nextValue) {
+        decodedImg.at<uint16_t>(y, x) = value;
+
+        /// the projected bit that changes at the border, when several do
+        /// (it can only happen with binary code) the most significant one is
+        /// used, its stripes are the widest so they are less affected by blur
+        const unsigned int projected = isGrayCode ? binaryToGray(value) : value;
+        const unsigned int nextProjected = isGrayCode ? binaryToGray(nextValue) : nextValue;
+        const unsigned int changedBits = projected ^ nextProjected;
+        int bit = 0;
+        while (changedBits >> (bit + 1)) {
+            ++bit;
+        }
+
+        /// the border is where normal - inverted changes sign, interpolate
+        /// it linearly between both pixels. If the profiles don't agree
+        /// with the codes use the middle, like before
+        float offset = 0.5f;
+        const int imageIndex = bitCount - 1 - bit;
+        if (imageIndex >= 0 && imageIndex < bitCount) {
+            const uint8_t *imgRow = images[size_t(imageIndex)].ptr<uint8_t>(y);
+            const uint8_t *invImgRow = invImages[size_t(imageIndex)].ptr<uint8_t>(y);
+            const float diff = float(imgRow[x]) - float(invImgRow[x]);
+            const float nextDiff = float(imgRow[x+1]) - float(invImgRow[x+1]);
+            if ((diff > 0.f) != (nextDiff > 0.f) && diff != nextDiff) {
+                offset = std::min(1.f, std::max(0.f, diff / (diff - nextDiff)));
+            }
+        }
+
+        const cv::Vec2f point(x + offset, y);
+        const uint16_t imin = std::min(value, nextValue);
+        const uint16_t imax = std::max(value, nextValue);
+        fringePoints.addPoint(imin, point);
+        if (imax - imin > 1) {
+            fringePoints.addPoint(imax - 1, point);
+        }
+    });
+
+    return decodedImg;
+}
+
+} // namespace ZBinaryPatternDecoder
+
+} // namespace Z3D
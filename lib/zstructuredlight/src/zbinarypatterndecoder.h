@@ -0,0 +1,80 @@
+/* * Z3D - A structured light 3D scanner
+ * Copyright (C) 2013-2016 Nicolas Ulrich <nikolaseu@gmail.com>
+ *
+ * This file is part of Z3D.
+ *
+ * Z3D is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Z3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Z3D.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "zstructuredlight_global.h"
+
+#include <opencv2/core/mat.hpp>
+
+#include <vector>
+
+namespace Z3D
+{
+
+class ZFringePoints;
+
+namespace ZBinaryPatternDecoder
+{
+
+/// if confidenceImg is not null it's set to the confidence of each pixel (CV_8UC1),
+/// the minimum contrast between the normal and inverted images of all the bits.
+/// Low values mean some bit could have been flipped by noise.
+/// If roi is not empty only that region is decoded, the rest is set to NO_VALUE.
+/// The decoded image is fixed point (CV_16UC1, see ZDecodedPattern) unless
+/// decodedType is CV_32FC1 or there are too many bits for fixed point codes
+Z3D_STRUCTUREDLIGHT_SHARED_EXPORT cv::Mat decodeBinaryPatternImages(const std::vector<cv::Mat> &images, const std::vector<cv::Mat> &invImages, cv::Mat maskImg, bool isGrayCode = true, cv::Mat *confidenceImg = nullptr, const cv::Rect &roi = cv::Rect(), int decodedType = CV_16UC1);
+
+/// decodes only rows [rowBegin, rowEnd) into decodedImg (CV_16UC1 or CV_32FC1, already allocated)
+/// and confidenceImg (CV_8UC1, already allocated, optional).
+/// Different row ranges can be decoded concurrently
+Z3D_STRUCTUREDLIGHT_SHARED_EXPORT void decodeBinaryPatternImageRows(const std::vector<cv::Mat> &images, const std::vector<cv::Mat> &invImages, cv::Mat maskImg, bool isGrayCode, cv::Mat decodedImg, int rowBegin, int rowEnd, cv::Mat confidenceImg = cv::Mat());
+
+/// incremental decoding, one normal/inverted pair at a time (most significant bit first).
+/// codeImg is (re)created as a CV_16UC1 image and confidenceImg as a CV_8UC1 image if needed
+Z3D_STRUCTUREDLIGHT_SHARED_EXPORT void accumulateBinaryPatternImage(const cv::Mat &image, const cv::Mat &invImage, cv::Mat maskImg, cv::Mat &codeImg, cv::Mat &confidenceImg);
+
+/// converts the accumulated codes to the final decoded image. codeImg is modified in place
+Z3D_STRUCTUREDLIGHT_SHARED_EXPORT cv::Mat finishBinaryPatternDecoding(cv::Mat codeImg, cv::Mat maskImg, bool isGrayCode = true, int decodedType = CV_16UC1);
+
+/// same as finishBinaryPatternDecoding but only for rows [rowBegin, rowEnd), decodedImg must be already allocated
+Z3D_STRUCTUREDLIGHT_SHARED_EXPORT void finishBinaryPatternDecodingRows(cv::Mat codeImg, cv::Mat maskImg, bool isGrayCode, cv::Mat decodedImg, int rowBegin, int rowEnd);
+
+/// mask of the valid pixels, where the contrast between the all white and all
+/// black images is greater than noiseThreshold. Only the region roi is used
+/// (empty means the whole image), it's updated to the part of the image that
+/// was actually used and, if fitToMask is true, reduced to the bounding box of
+/// the valid pixels. The mask returned is the size of the final roi
+Z3D_STRUCTUREDLIGHT_SHARED_EXPORT cv::Mat referenceMaskImage(const cv::Mat &whiteImg, const cv::Mat &blackImg, int noiseThreshold, cv::Rect &roi, bool fitToMask = false);
+
+/// per-pixel threshold used when the inverted patterns are not projected, the
+/// mean of the all white and all black images (CV_8UC1). It can be used in place
+/// of every inverted image, a bit is set when the pixel is brighter than it
+Z3D_STRUCTUREDLIGHT_SHARED_EXPORT cv::Mat binaryThresholdImage(const cv::Mat &whiteImg, const cv::Mat &blackImg);
+
+/// finds the fringe borders of a decoded image (as returned by
+/// decodeBinaryPatternImages), where the code changes between adjacent pixels.
+/// The sub-pixel position of each border is interpolated from the normal and
+/// inverted images used to decode it. Returns the codes at the borders
+/// (CV_16U, 0 elsewhere) and the points of each fringe in fringePoints
+Z3D_STRUCTUREDLIGHT_SHARED_EXPORT cv::Mat simplifyBinaryPatternData(cv::Mat image, const std::vector<cv::Mat> &images, const std::vector<cv::Mat> &invImages, cv::Mat maskImg, bool isGrayCode, ZFringePoints &fringePoints);
+
+} // namespace ZBinaryPatternDecoder
+
+}// namespace Z3D
@@ -22,18 +22,24 @@
 #include "zcameraimage.h"
 #include "zcamerainterface.h"
 
+#include <QDebug>
 #include <QDir>
+#include <QFuture>
+#include <QTime>
+#include <QtConcurrentRun>
 
 namespace Z3D {
 
 ZCameraAcquisitionManager::ZCameraAcquisitionManager(ZCameraList cameras, QObject *parent)
     : QObject(parent)
     , m_cameras(cameras)
+    , m_burstArmed(false)
+    , m_debugMode(false)
 {
 
 }
 
-void ZCameraAcquisitionManager::prepareAcquisition(QString acquisitionId)
+void ZCameraAcquisitionManager::prepareAcquisition(QString acquisitionId, int burstFrameCount)
 {
     m_acquisitionId = acquisitionId;
 
@@ -58,11 +64,36 @@ void ZCameraAcquisitionManager::prepareAcquisition(QString acquisitionId)
         cam->startAcquisition();
     }
 
+    /// arm every camera for the whole sequence, if possible
+    m_burstArmed = false;
+    m_burstIds.clear();
+    if (burstFrameCount > 0) {
+        m_burstArmed = true;
+        for (auto cam : m_cameras) {
+            if (!cam->armBurst(burstFrameCount)) {
+                m_burstArmed = false;
+            }
+        }
+
+        if (!m_burstArmed) {
+            qWarning() << "burst acquisition not available for every camera, acquiring one frame at a time";
+            /// disarm the ones that succeeded
+            for (auto cam : m_cameras) {
+                cam->getBurst();
+            }
+        }
+    }
+
     emit acquisitionReady(m_acquisitionId);
 }
 
 void ZCameraAcquisitionManager::acquireSingle(QString id)
 {
+    if (m_burstArmed) {
+        acquireBurstFrame(id);
+        return;
+    }
+
     for (auto cam : m_cameras) {
         /// if the camera is simulated, set which image should use now
         if (cam->uuid().startsWith("ZSIMULATED")) {
@@ -76,35 +107,56 @@ void ZCameraAcquisitionManager::acquireSingle(QString id)
 
     m_images.push_back(std::vector<Z3D::ZCameraImagePtr>());
     auto &images = m_images.back();
-    images.reserve(m_cameras.size());
+    images.resize(m_cameras.size());
+
+    std::vector<int> latencies(m_cameras.size(), 0);
+
+    const auto retrieveSnapshot = [&](size_t iCam) {
+        QTime time;
+        time.start();
+
+        auto &cam = m_cameras[iCam];
 
-    for (auto cam : m_cameras) {
         /// Retrieve the image, this will block until the snapshot is retrieved
         auto imptr = cam->getSnapshot();
 
-        if (imptr) {
-            /// create a deep copy, the camera might return a temporary
+        /// create a deep copy if the camera might return a temporary
+        if (imptr && !cam->snapshotIsCopy()) {
             imptr = imptr->clone();
-
-            if (m_debugMode) {
-                /// save image
-                ZCameraImage::save(imptr, QString("%1/%2/%3")
-                            .arg(m_acquisitionId)
-                            .arg(cam->uuid())
-                            .arg(id));
-            }
-        } else {
-            qCritical() << "error obtaining snapshot for camera" << cam->uuid();
         }
 
-        images.push_back(imptr);
+        images[iCam] = imptr;
+        latencies[iCam] = time.elapsed();
+    };
+
+    QTime acquisitionTime;
+    acquisitionTime.start();
+
+    /// wait for all the cameras at the same time, so it takes as long as the
+    /// slowest camera instead of the sum of all of them
+    std::vector< QFuture<void> > futures;
+    futures.reserve(m_cameras.size());
+    for (size_t iCam=1; iCam<m_cameras.size(); ++iCam) {
+        futures.push_back(QtConcurrent::run([&retrieveSnapshot, iCam]() { retrieveSnapshot(iCam); }));
+    }
+    if (!m_cameras.empty()) {
+        retrieveSnapshot(0);
+    }
+    for (auto &future : futures) {
+        future.waitForFinished();
     }
 
-    emit imagesAcquired(images, id);
+    qDebug() << "snapshot" << id << "acquired in" << acquisitionTime.elapsed() << "msecs, per camera:" << latencies;
+
+    notifyImagesAcquired(images, id);
 }
 
 void ZCameraAcquisitionManager::finishAcquisition()
 {
+    if (m_burstArmed) {
+        retrieveBurst();
+    }
+
     /// stop acquisition
     for (auto cam : m_cameras) {
         cam->stopAcquisition();
@@ -113,4 +165,85 @@ void ZCameraAcquisitionManager::finishAcquisition()
     emit acquisitionFinished(m_images, m_acquisitionId);
 }
 
+void ZCameraAcquisitionManager::acquireBurstFrame(QString id)
+{
+    const int index = int(m_burstIds.size());
+    m_burstIds.push_back(id);
+
+    for (auto cam : m_cameras) {
+        /// if the camera is simulated, set which image should use now
+        if (cam->uuid().startsWith("ZSIMULATED")) {
+            cam->setAttribute("CurrentFile", id);
+        }
+
+        cam->requestSnapshot();
+    }
+
+    /// the frame is stored by the camera, we only have to wait for it so the
+    /// pattern is not changed during the exposure
+    std::vector< QFuture<bool> > futures;
+    futures.reserve(m_cameras.size());
+    for (size_t iCam=1; iCam<m_cameras.size(); ++iCam) {
+        auto cam = m_cameras[iCam];
+        futures.push_back(QtConcurrent::run([cam, index]() { return cam->waitForBurstFrame(index); }));
+    }
+    if (!m_cameras.empty()) {
+        m_cameras[0]->waitForBurstFrame(index);
+    }
+    for (auto &future : futures) {
+        future.waitForFinished();
+    }
+}
+
+void ZCameraAcquisitionManager::retrieveBurst()
+{
+    m_burstArmed = false;
+
+    /// 1st index: camera index
+    /// 2nd index: image number / order
+    std::vector< std::vector<Z3D::ZCameraImagePtr> > bursts;
+    bursts.reserve(m_cameras.size());
+    for (auto cam : m_cameras) {
+        bursts.push_back(cam->getBurst());
+    }
+
+    for (size_t iImage=0; iImage<m_burstIds.size(); ++iImage) {
+        m_images.push_back(std::vector<Z3D::ZCameraImagePtr>());
+        auto &images = m_images.back();
+        images.resize(m_cameras.size());
+
+        for (size_t iCam=0; iCam<m_cameras.size(); ++iCam) {
+            if (iImage < bursts[iCam].size()) {
+                images[iCam] = bursts[iCam][iImage];
+            }
+        }
+
+        notifyImagesAcquired(images, m_burstIds[iImage]);
+    }
+
+    qDebug() << "burst of" << m_burstIds.size() << "frames retrieved";
+
+    m_burstIds.clear();
+}
+
+void ZCameraAcquisitionManager::notifyImagesAcquired(std::vector<ZCameraImagePtr> &images, QString id)
+{
+    for (size_t iCam=0; iCam<m_cameras.size(); ++iCam) {
+        const auto &cam = m_cameras[iCam];
+        const auto &imptr = images[iCam];
+
+        if (!imptr) {
+            qCritical() << "error obtaining snapshot for camera" << cam->uuid();
+        } else if (m_debugMode) {
+            /// save image
+            ZCameraImage::save(imptr, QString("%1/%2/%3")
+                        .arg(m_acquisitionId)
+                        .arg(cam->uuid())
+                        .arg(id));
+        }
+    }
+
+    emit imagesAcquired(images, id);
+}
+
 } // namespace Z3D {
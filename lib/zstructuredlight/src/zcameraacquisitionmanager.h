@@ -40,11 +40,15 @@ signals:
     void acquisitionFinished(std::vector< std::vector<Z3D::ZCameraImagePtr> > &acquiredImages, QString acquisitionId);
 
 public slots:
-    void prepareAcquisition(QString acquisitionId);
+    void prepareAcquisition(QString acquisitionId, int burstFrameCount = 0);
     void acquireSingle(QString id);
     void finishAcquisition();
 
 private:
+    void acquireBurstFrame(QString id);
+    void retrieveBurst();
+    void notifyImagesAcquired(std::vector<Z3D::ZCameraImagePtr> &images, QString id);
+
     Z3D::ZCameraList m_cameras;
 
     // 1st index: image number / order
@@ -53,6 +57,10 @@ private:
 
     QString m_acquisitionId;
 
+    /// true when every camera is armed to acquire the whole sequence
+    bool m_burstArmed;
+    std::vector<QString> m_burstIds;
+
     bool m_debugMode;
 };
 
@@ -0,0 +1,160 @@
+//
+// Z3D - A structured light 3D scanner
+// Copyright (C) 2013-2016 Nicolas Ulrich <nikolaseu@gmail.com>
+//
+// This file is part of Z3D.
+//
+// Z3D is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Z3D is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Z3D.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "zcoderowindex.h"
+
+#include "zdecodedpattern.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace Z3D
+{
+
+constexpr float ZCodeRowIndex::MAX_CODE_STEP;
+
+ZCodeRowIndex::ZCodeRowIndex()
+{
+
+}
+
+void ZCodeRowIndex::build(const float *rowData, int width)
+{
+    findCodeRuns(rowData, width, m_runs);
+
+    m_segments.clear();
+    for (size_t i=1; i<m_runs.size(); ++i) {
+        const CodeRun &run = m_runs[i-1];
+        const CodeRun &nextRun = m_runs[i];
+        if (areConnected(run, nextRun)) {
+            m_segments.push_back(codeSegment(run, nextRun));
+        }
+    }
+
+    std::sort(m_segments.begin(), m_segments.end(), [](const CodeSegment &a, const CodeSegment &b) {
+        return a.codeBegin < b.codeBegin;
+    });
+}
+
+bool ZCodeRowIndex::empty() const
+{
+    return m_segments.empty();
+}
+
+bool ZCodeRowIndex::findColumn(float code, float *column) const
+{
+    /// all the segments that might contain the code start in
+    /// [code - MAX_CODE_STEP, code]
+    auto it = std::upper_bound(m_segments.cbegin(), m_segments.cend(), code, [](float code, const CodeSegment &segment) {
+        return code < segment.codeBegin;
+    });
+
+    bool found = false;
+    float foundColumn = 0;
+    while (it != m_segments.cbegin()) {
+        --it;
+        if (it->codeBegin < code - MAX_CODE_STEP) {
+            break;
+        }
+        if (code > it->codeEnd) {
+            continue;
+        }
+
+        const float segmentColumn = it->columnBegin + (it->columnEnd - it->columnBegin) * (code - it->codeBegin) / (it->codeEnd - it->codeBegin);
+        if (!found) {
+            foundColumn = segmentColumn;
+            found = true;
+        } else if (std::fabs(segmentColumn - foundColumn) > 0.5f) {
+            /// a run center is shared by two segments, that's fine,
+            /// but otherwise we don't know which one is right
+            return false;
+        }
+    }
+
+    if (found) {
+        *column = foundColumn;
+    }
+
+    return found;
+}
+
+void ZCodeRowIndex::subPixelCodes(const float *rowData, int width, float *codes)
+{
+    std::fill(codes, codes + width, std::numeric_limits<float>::quiet_NaN());
+
+    std::vector<CodeRun> runs;
+    findCodeRuns(rowData, width, runs);
+    for (size_t i=0; i<runs.size(); ++i) {
+        const CodeRun &run = runs[i];
+        const CodeRun *prevRun = i > 0 && areConnected(runs[i-1], run) ? &runs[i-1] : nullptr;
+        const CodeRun *nextRun = i+1 < runs.size() && areConnected(run, runs[i+1]) ? &runs[i+1] : nullptr;
+
+        for (int x=run.begin; x<=run.end; ++x) {
+            if (float(x) < run.center && prevRun) {
+                codes[x] = prevRun->code + (run.code - prevRun->code) * (float(x) - prevRun->center) / (run.center - prevRun->center);
+            } else if (float(x) > run.center && nextRun) {
+                codes[x] = run.code + (nextRun->code - run.code) * (float(x) - run.center) / (nextRun->center - run.center);
+            } else if (run.complete && std::fabs(float(x) - run.center) < 0.25f) {
+                codes[x] = run.code;
+            }
+            /// else border of an isolated run, position is not known
+        }
+    }
+}
+
+void ZCodeRowIndex::findCodeRuns(const float *rowData, int width, std::vector<CodeRun> &runs)
+{
+    runs.clear();
+    for (int x=0; x<width; ++x) {
+        const float code = rowData[x];
+        if (code == ZDecodedPattern::NO_VALUE) {
+            continue;
+        }
+
+        const int begin = x;
+        while (x+1 < width && rowData[x+1] == code) {
+            ++x;
+        }
+        const bool complete = begin > 0 && rowData[begin-1] != ZDecodedPattern::NO_VALUE
+                && x+1 < width && rowData[x+1] != ZDecodedPattern::NO_VALUE;
+        runs.push_back({ code, 0.5f * float(begin + x), begin, x, complete });
+    }
+}
+
+bool ZCodeRowIndex::areConnected(const CodeRun &run, const CodeRun &nextRun)
+{
+    const float step = std::fabs(nextRun.code - run.code);
+    return run.complete
+            && nextRun.complete
+            && nextRun.begin == run.end + 1
+            && step > 0.f
+            && step <= MAX_CODE_STEP;
+}
+
+ZCodeRowIndex::CodeSegment ZCodeRowIndex::codeSegment(const CodeRun &run, const CodeRun &nextRun)
+{
+    if (run.code < nextRun.code) {
+        return { run.code, nextRun.code, run.center, nextRun.center };
+    }
+    return { nextRun.code, run.code, nextRun.center, run.center };
+}
+
+} // namespace Z3D
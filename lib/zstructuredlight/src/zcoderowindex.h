@@ -0,0 +1,93 @@
+/* * Z3D - A structured light 3D scanner
+ * Copyright (C) 2013-2016 Nicolas Ulrich <nikolaseu@gmail.com>
+ *
+ * This file is part of Z3D.
+ *
+ * Z3D is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Z3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Z3D.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+#pragma once
+
+#include "zstructuredlight_global.h"
+
+#include <vector>
+
+namespace Z3D
+{
+
+/// Sorted index of the codes of one row of a decoded image, used to find the
+/// (sub-pixel) column of a code.
+/// Runs of equal codes are replaced by their center, and the code is linearly
+/// interpolated between connected runs (next to each other, code increasing
+/// or decreasing but not too much, i.e. no occlusion or discontinuity
+/// between them).
+/// Doesn't need the codes to be monotonic along the row, codes found more
+/// than once in the row are ambiguous
+class Z3D_STRUCTUREDLIGHT_SHARED_EXPORT ZCodeRowIndex
+{
+public:
+    /// maximum difference between the codes of neighbour runs to consider them
+    /// part of the same surface (consecutive fringes differ by 1)
+    static constexpr float MAX_CODE_STEP = 2.f;
+
+    ZCodeRowIndex();
+
+    /// discards the previous row and indexes rowData, width values where
+    /// ZDecodedPattern::NO_VALUE means no code
+    void build(const float *rowData, int width);
+
+    bool empty() const;
+
+    /// column of code in the indexed row, false if it's not there or if it's
+    /// ambiguous
+    bool findColumn(float code, float *column) const;
+
+    /// sub-pixel code of every pixel of the row, interpolated from the run
+    /// centers. NaN where it can't be known (no code, border of an isolated run)
+    static void subPixelCodes(const float *rowData, int width, float *codes);
+
+private:
+    /// a run of consecutive pixels with exactly the same code
+    struct CodeRun
+    {
+        float code;
+        float center;
+        int begin;
+        int end; /// inclusive
+        bool complete; /// false if the run is cut by the border or by invalid pixels, the center is not reliable
+    };
+
+    /// a piece of a row where the code changes linearly between two run centers.
+    /// codeBegin < codeEnd, and columnBegin is the column of codeBegin, so it's
+    /// after columnEnd where the code decreases along the row
+    struct CodeSegment
+    {
+        float codeBegin;
+        float codeEnd;
+        float columnBegin;
+        float columnEnd;
+    };
+
+    static void findCodeRuns(const float *rowData, int width, std::vector<CodeRun> &runs);
+    static bool areConnected(const CodeRun &run, const CodeRun &nextRun);
+    static CodeSegment codeSegment(const CodeRun &run, const CodeRun &nextRun);
+
+    std::vector<CodeRun> m_runs;
+    /// sorted by codeBegin
+    std::vector<CodeSegment> m_segments;
+};
+
+} // namespace Z3D
@@ -24,18 +24,77 @@
 
 #include <QMetaType>
 
+#include <opencv2/core.hpp>
+
 namespace Z3D
 {
 
 static int z3dDecodedPatternPtrTypeId = qRegisterMetaType<Z3D::ZDecodedPatternPtr>("Z3D::ZDecodedPatternPtr");
 
 const float_t ZDecodedPattern::NO_VALUE = std::numeric_limits<float_t>::min();
+constexpr int ZDecodedPattern::FIXED_POINT_FRACTION_BITS;
+constexpr uint16_t ZDecodedPattern::FIXED_POINT_NO_VALUE;
+constexpr int ZDecodedPattern::FIXED_POINT_MAX_CODE;
+
+namespace
+{
+
+constexpr float FIXED_POINT_SCALE = float(1 << ZDecodedPattern::FIXED_POINT_FRACTION_BITS);
+
+} // anonymous namespace
+
+double ZDecodedPattern::noValue(int type)
+{
+    return type == CV_16UC1
+            ? double(FIXED_POINT_NO_VALUE)
+            : double(NO_VALUE);
+}
+
+void ZDecodedPattern::convertDecodedImage(const cv::Mat &src, cv::Mat &dst, int type)
+{
+    if (src.type() == type) {
+        src.copyTo(dst);
+        return;
+    }
+
+    if (type == CV_16UC1) {
+        /// negative values (and NaN) saturate to 0, i.e. no value
+        const cv::Mat invalid = (src == NO_VALUE) | (src > float(FIXED_POINT_MAX_CODE));
+        src.convertTo(dst, CV_16U, FIXED_POINT_SCALE, FIXED_POINT_SCALE);
+        dst.setTo(FIXED_POINT_NO_VALUE, invalid);
+        return;
+    }
+
+    const cv::Mat invalid = src == FIXED_POINT_NO_VALUE;
+    src.convertTo(dst, CV_32F, 1. / FIXED_POINT_SCALE, -1.);
+    dst.setTo(NO_VALUE, invalid);
+}
+
+const float *ZDecodedPattern::codeRow(const cv::Mat &decodedImage, int y, int x, int width, std::vector<float> &buffer)
+{
+    if (decodedImage.type() != CV_16UC1) {
+        return decodedImage.ptr<float>(y) + x;
+    }
+
+    buffer.resize(size_t(width));
+    const uint16_t *row = decodedImage.ptr<uint16_t>(y) + x;
+    for (int i=0; i<width; ++i) {
+        buffer[size_t(i)] = row[i] == FIXED_POINT_NO_VALUE
+                ? NO_VALUE
+                : float(row[i]) * (1.f / FIXED_POINT_SCALE) - 1.f;
+    }
+    return buffer.data();
+}
 
 ZDecodedPattern::ZDecodedPattern(cv::Mat decodedImage,
                                  cv::Mat intensityImg,
-                                 std::map<int, std::vector<cv::Vec2f> > fringePointsList)
-    : ZStructuredLightPattern(decodedImage, fringePointsList)
+                                 cv::Mat confidenceImg,
+                                 cv::Rect roi,
+                                 ZFringePoints fringePoints)
+    : ZStructuredLightPattern(decodedImage, std::move(fringePoints))
     , m_intensityImg(intensityImg)
+    , m_confidenceImg(confidenceImg)
+    , m_roi(roi)
 {
 
 }
@@ -45,4 +104,26 @@ cv::Mat ZDecodedPattern::intensityImg() const
     return m_intensityImg;
 }
 
+cv::Mat ZDecodedPattern::confidenceImg() const
+{
+    return m_confidenceImg;
+}
+
+cv::Mat ZDecodedPattern::decodedImage(int minConfidence) const
+{
+    const cv::Mat decodedImg = decodedImage();
+    if (minConfidence <= 0 || m_confidenceImg.empty()) {
+        return decodedImg;
+    }
+
+    cv::Mat filteredImg = decodedImg.clone();
+    filteredImg.setTo(noValue(filteredImg.type()), m_confidenceImg < minConfidence);
+    return filteredImg;
+}
+
+cv::Rect ZDecodedPattern::roi() const
+{
+    return m_roi;
+}
+
 } // namespace Z3D
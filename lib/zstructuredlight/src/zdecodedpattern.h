@@ -25,22 +25,65 @@
 
 #include <opencv2/core/mat.hpp>
 
+#include <vector>
+
 namespace Z3D
 {
 
+/// Decoded images are fixed point (CV_16UC1) by default, half the size of
+/// floating point (CV_32FC1) ones, so they are faster to decode, remap and
+/// match. Fixed point values are (code + 1) * 2^FIXED_POINT_FRACTION_BITS, so
+/// there are a few bits for sub-fringe (i.e. phase shift) positions and 0 can
+/// be used for pixels without value, like NO_VALUE (almost 0) in floating point
 struct Z3D_STRUCTUREDLIGHT_SHARED_EXPORT ZDecodedPattern : public ZStructuredLightPattern
 {
 public:
     static const float_t NO_VALUE;
 
+    static constexpr int FIXED_POINT_FRACTION_BITS = 4;
+    static constexpr uint16_t FIXED_POINT_NO_VALUE = 0;
+    /// largest code that fits in a fixed point decoded image
+    static constexpr int FIXED_POINT_MAX_CODE = (0xFFFF >> FIXED_POINT_FRACTION_BITS) - 1;
+
+    /// value used for the pixels without code in decoded images of type
+    static double noValue(int type);
+
+    /// converts a decoded image to type (CV_32FC1 or CV_16UC1), keeping the
+    /// pixels without code. Codes that don't fit in fixed point are discarded
+    static void convertDecodedImage(const cv::Mat &src, cv::Mat &dst, int type);
+
+    /// width codes of row y of a decoded image (of any type), starting at
+    /// column x, in floating point. Returns the row itself for floating point
+    /// images, fixed point rows are converted into buffer
+    static const float *codeRow(const cv::Mat &decodedImage, int y, int x, int width, std::vector<float> &buffer);
+
     explicit ZDecodedPattern(cv::Mat decodedImage,
                              cv::Mat intensityImg,
-                             std::map<int, std::vector<cv::Vec2f> > fringePointsList = std::map<int, std::vector<cv::Vec2f> >());
+                             cv::Mat confidenceImg = cv::Mat(),
+                             cv::Rect roi = cv::Rect(),
+                             ZFringePoints fringePoints = ZFringePoints());
 
     cv::Mat intensityImg() const;
 
+    /// how reliable is the decoded value of each pixel (CV_8UC1, higher is
+    /// better, 0 outside the mask). Empty if the pattern doesn't provide it
+    cv::Mat confidenceImg() const;
+
+    /// the decoded image without the pixels with confidence lower than
+    /// minConfidence (set to NO_VALUE). It's the same decoded image if there
+    /// is nothing to discard
+    cv::Mat decodedImage(int minConfidence) const;
+    using ZStructuredLightPattern::decodedImage;
+
+    /// region of the image that was decoded, everything outside is NO_VALUE.
+    /// It's the whole image if the pattern was decoded completely and empty
+    /// if nothing was decoded (e.g. nothing lit with auto roi)
+    cv::Rect roi() const;
+
 private:
     cv::Mat m_intensityImg;
+    cv::Mat m_confidenceImg;
+    cv::Rect m_roi;
 };
 
 } // namespace Z3D
@@ -0,0 +1,128 @@
+//
+// Z3D - A structured light 3D scanner
+// Copyright (C) 2013-2016 Nicolas Ulrich <nikolaseu@gmail.com>
+//
+// This file is part of Z3D.
+//
+// Z3D is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Z3D is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Z3D.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "zfringepoints.h"
+
+#include <QDebug>
+
+#include <algorithm>
+
+namespace Z3D
+{
+
+ZFringePoints::ZFringePoints()
+    : m_offsets(1, 0)
+    , m_firstCode(0)
+{
+
+}
+
+size_t ZFringePoints::fringeCount() const
+{
+    return m_codes.size();
+}
+
+size_t ZFringePoints::pointCount() const
+{
+    return m_points.size();
+}
+
+bool ZFringePoints::empty() const
+{
+    return m_codes.empty();
+}
+
+int ZFringePoints::code(size_t fringe) const
+{
+    return m_codes[fringe];
+}
+
+size_t ZFringePoints::pointCount(size_t fringe) const
+{
+    return m_offsets[fringe + 1] - m_offsets[fringe];
+}
+
+const cv::Vec2f *ZFringePoints::pointsBegin(size_t fringe) const
+{
+    return m_points.data() + m_offsets[fringe];
+}
+
+const cv::Vec2f *ZFringePoints::pointsEnd(size_t fringe) const
+{
+    return m_points.data() + m_offsets[fringe + 1];
+}
+
+ZFringePoints::Fringe ZFringePoints::fringe(size_t fringe) const
+{
+    return Fringe { m_codes[fringe], pointsBegin(fringe), pointsEnd(fringe) };
+}
+
+ZFringePoints::Fringe ZFringePoints::find(int code) const
+{
+    const auto it = std::lower_bound(m_codes.cbegin(), m_codes.cend(), code);
+    if (it == m_codes.cend() || *it != code) {
+        return Fringe { code, nullptr, nullptr };
+    }
+
+    return fringe(size_t(it - m_codes.cbegin()));
+}
+
+void ZFringePoints::allocate(const std::vector<size_t> &pointsPerCode, int firstCode)
+{
+    m_codes.clear();
+    m_offsets.assign(1, 0);
+    m_firstCode = firstCode;
+    /// codes without points are kept out of the table, they are marked
+    /// with an invalid position so adding a point to them is detected
+    m_writePositions.assign(pointsPerCode.size(), size_t(-1));
+    m_writeEnds.assign(pointsPerCode.size(), 0);
+
+    size_t totalPoints = 0;
+    for (size_t i=0; i<pointsPerCode.size(); ++i) {
+        if (pointsPerCode[i]) {
+            m_writePositions[i] = totalPoints;
+            totalPoints += pointsPerCode[i];
+            m_writeEnds[i] = totalPoints;
+            m_codes.push_back(firstCode + int(i));
+            m_offsets.push_back(totalPoints);
+        }
+    }
+
+    m_points.resize(totalPoints);
+}
+
+void ZFringePoints::addPoint(int code, const cv::Vec2f &point)
+{
+    const size_t index = size_t(code - m_firstCode);
+    if (code < m_firstCode || index >= m_writePositions.size() || m_writePositions[index] == size_t(-1)) {
+        qWarning() << "trying to add a point to a code that was not allocated:" << code;
+        return;
+    }
+
+    /// more points than allocated would overwrite the next code's points
+    if (m_writePositions[index] >= m_writeEnds[index]) {
+        qWarning() << "trying to add more points than allocated to code:" << code;
+        return;
+    }
+
+    m_points[m_writePositions[index]++] = point;
+}
+
+} // namespace Z3D
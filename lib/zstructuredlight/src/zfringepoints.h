@@ -0,0 +1,96 @@
+/* * Z3D - A structured light 3D scanner
+ * Copyright (C) 2013-2016 Nicolas Ulrich <nikolaseu@gmail.com>
+ *
+ * This file is part of Z3D.
+ *
+ * Z3D is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Z3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Z3D.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include "zstructuredlight_global.h"
+
+#include <opencv2/core/mat.hpp>
+
+#include <vector>
+
+namespace Z3D
+{
+
+/// Fringe points grouped by code, stored as a compressed sparse row table:
+/// the codes (sorted), the offset of the first point of each code and a
+/// single array with all the points. Filled in two passes, first counting
+/// the points of every code and then adding them, so there is only one
+/// allocation per array.
+/// It can be moved but not copied, the points of a whole pattern can be
+/// megabytes, use a reference or the views to read them
+class Z3D_STRUCTUREDLIGHT_SHARED_EXPORT ZFringePoints
+{
+public:
+    /// points of one fringe, only valid while the container is not modified
+    struct Fringe
+    {
+        int code;
+        const cv::Vec2f *begin;
+        const cv::Vec2f *end;
+
+        size_t size() const { return size_t(end - begin); }
+        bool empty() const { return begin == end; }
+    };
+
+    ZFringePoints();
+
+    ZFringePoints(ZFringePoints &&other) = default;
+    ZFringePoints &operator=(ZFringePoints &&other) = default;
+
+    ZFringePoints(const ZFringePoints &other) = delete;
+    ZFringePoints &operator=(const ZFringePoints &other) = delete;
+
+    /// number of fringes, i.e. codes with at least one point
+    size_t fringeCount() const;
+    size_t pointCount() const;
+    bool empty() const;
+
+    int code(size_t fringe) const;
+    size_t pointCount(size_t fringe) const;
+    const cv::Vec2f *pointsBegin(size_t fringe) const;
+    const cv::Vec2f *pointsEnd(size_t fringe) const;
+
+    Fringe fringe(size_t fringe) const;
+
+    /// the fringe with the given code, empty if there isn't one
+    Fringe find(int code) const;
+
+    /// discards everything and prepares the storage, pointsPerCode[i] is the
+    /// number of points that will be added for code firstCode + i
+    void allocate(const std::vector<size_t> &pointsPerCode, int firstCode = 0);
+
+    /// adds a point to a code that was allocated, points of each code are
+    /// kept in the order they were added
+    void addPoint(int code, const cv::Vec2f &point);
+
+private:
+    std::vector<int> m_codes;
+    std::vector<size_t> m_offsets;
+    std::vector<cv::Vec2f> m_points;
+
+    /// only used while adding the points, next free position of each code
+    /// and the end of its points (the offset of the next code)
+    int m_firstCode;
+    std::vector<size_t> m_writePositions;
+    std::vector<size_t> m_writeEnds;
+};
+
+} // namespace Z3D
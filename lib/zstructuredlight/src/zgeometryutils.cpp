@@ -20,6 +20,15 @@
 
 #include "zgeometryutils.h"
 
+#include "zsimdutils.h"
+
+#include <opencv2/core.hpp> // determinant
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <limits>
+
 namespace Z3D
 {
 
@@ -57,4 +66,258 @@ cv::Vec3d GeometryUtils::intersectLineWithLine3D(const cv::Vec3d &q1, const cv::
     return p;
 }
 
+namespace
+{
+
+typedef void (*IntersectLinesFunc)(const float * const q1[3], const float * const v1[3], const float * const q2[3], const float * const v2[3], size_t begin, size_t end, cv::Vec4f *results);
+
+void intersectLinesScalar(const float * const q1[3], const float * const v1[3], const float * const q2[3], const float * const v2[3], size_t begin, size_t end, cv::Vec4f *results)
+{
+    for (size_t i=begin; i<end; ++i) {
+        const float q12[3] = { q1[0][i] - q2[0][i], q1[1][i] - q2[1][i], q1[2][i] - q2[2][i] };
+        const float v1_dot_v2 = v1[0][i]*v2[0][i] + v1[1][i]*v2[1][i] + v1[2][i]*v2[2][i];
+        const float q12_dot_v1 = q12[0]*v1[0][i] + q12[1]*v1[1][i] + q12[2]*v1[2][i];
+        const float q12_dot_v2 = q12[0]*v2[0][i] + q12[1]*v2[1][i] + q12[2]*v2[2][i];
+
+        /// same as intersectLineWithLine3D, with unit direction vectors
+        const float invDenom = 1.f / (1.f - v1_dot_v2*v1_dot_v2);
+        const float s = (v1_dot_v2*q12_dot_v2 - q12_dot_v1) * invDenom;
+        const float t = (q12_dot_v2 - v1_dot_v2*q12_dot_v1) * invDenom;
+
+        cv::Vec4f &result = results[i];
+        float distance = 0.f;
+        for (int k=0; k<3; ++k) {
+            const float np1 = q1[k][i] + v1[k][i] * s;
+            const float np2 = q2[k][i] + v2[k][i] * t;
+            result[k] = 0.5f * (np1 + np2);
+            distance += (np1 - np2) * (np1 - np2);
+        }
+        result[3] = distance;
+    }
+}
+
+#if defined(Z3D_SIMD_X86)
+
+Z3D_TARGET_SSE41
+void intersectLinesSSE41(const float * const q1[3], const float * const v1[3], const float * const q2[3], const float * const v2[3], size_t begin, size_t end, cv::Vec4f *results)
+{
+    const __m128 one = _mm_set1_ps(1.f);
+    const __m128 half = _mm_set1_ps(0.5f);
+
+    size_t i = begin;
+    for (; i + 4 <= end; i += 4) {
+        __m128 q1v[3], v1v[3], q2v[3], v2v[3], q12[3];
+        for (int k=0; k<3; ++k) {
+            q1v[k] = _mm_loadu_ps(q1[k] + i);
+            v1v[k] = _mm_loadu_ps(v1[k] + i);
+            q2v[k] = _mm_loadu_ps(q2[k] + i);
+            v2v[k] = _mm_loadu_ps(v2[k] + i);
+            q12[k] = _mm_sub_ps(q1v[k], q2v[k]);
+        }
+
+        __m128 v1_dot_v2 = _mm_mul_ps(v1v[0], v2v[0]);
+        __m128 q12_dot_v1 = _mm_mul_ps(q12[0], v1v[0]);
+        __m128 q12_dot_v2 = _mm_mul_ps(q12[0], v2v[0]);
+        for (int k=1; k<3; ++k) {
+            v1_dot_v2 = _mm_add_ps(v1_dot_v2, _mm_mul_ps(v1v[k], v2v[k]));
+            q12_dot_v1 = _mm_add_ps(q12_dot_v1, _mm_mul_ps(q12[k], v1v[k]));
+            q12_dot_v2 = _mm_add_ps(q12_dot_v2, _mm_mul_ps(q12[k], v2v[k]));
+        }
+
+        const __m128 invDenom = _mm_div_ps(one, _mm_sub_ps(one, _mm_mul_ps(v1_dot_v2, v1_dot_v2)));
+        const __m128 s = _mm_mul_ps(_mm_sub_ps(_mm_mul_ps(v1_dot_v2, q12_dot_v2), q12_dot_v1), invDenom);
+        const __m128 t = _mm_mul_ps(_mm_sub_ps(q12_dot_v2, _mm_mul_ps(v1_dot_v2, q12_dot_v1)), invDenom);
+
+        __m128 point[3];
+        __m128 distance = _mm_setzero_ps();
+        for (int k=0; k<3; ++k) {
+            const __m128 np1 = _mm_add_ps(q1v[k], _mm_mul_ps(v1v[k], s));
+            const __m128 np2 = _mm_add_ps(q2v[k], _mm_mul_ps(v2v[k], t));
+            const __m128 diff = _mm_sub_ps(np1, np2);
+            point[k] = _mm_mul_ps(half, _mm_add_ps(np1, np2));
+            distance = _mm_add_ps(distance, _mm_mul_ps(diff, diff));
+        }
+
+        /// from components to (x, y, z, distance) for each pair
+        _MM_TRANSPOSE4_PS(point[0], point[1], point[2], distance);
+        _mm_storeu_ps(&results[i][0], point[0]);
+        _mm_storeu_ps(&results[i+1][0], point[1]);
+        _mm_storeu_ps(&results[i+2][0], point[2]);
+        _mm_storeu_ps(&results[i+3][0], distance);
+    }
+
+    intersectLinesScalar(q1, v1, q2, v2, i, end, results);
+}
+
+#endif // Z3D_SIMD_X86
+
+IntersectLinesFunc intersectLinesKernel()
+{
+    static const IntersectLinesFunc kernel = []() -> IntersectLinesFunc {
+#if defined(Z3D_SIMD_X86)
+        if (SimdUtils::bestSupportedLevel() >= SimdUtils::SimdSSE41) {
+            return &intersectLinesSSE41;
+        }
+#endif
+        return &intersectLinesScalar;
+    }();
+
+    return kernel;
+}
+
+typedef void (*IntersectPlanesFunc)(const cv::Vec3f &origin, const float * const v[3], const float * const planes[4], size_t begin, size_t end, cv::Vec4f *results);
+
+void intersectPlanesScalar(const cv::Vec3f &origin, const float * const v[3], const float * const planes[4], size_t begin, size_t end, cv::Vec4f *results)
+{
+    for (size_t i=begin; i<end; ++i) {
+        const float n_dot_v = planes[0][i]*v[0][i] + planes[1][i]*v[1][i] + planes[2][i]*v[2][i];
+        const float t = -planes[3][i] / n_dot_v;
+
+        cv::Vec4f &result = results[i];
+        for (int k=0; k<3; ++k) {
+            result[k] = origin[k] + t * v[k][i];
+        }
+        result[3] = t;
+    }
+}
+
+#if defined(Z3D_SIMD_X86)
+
+Z3D_TARGET_SSE41
+void intersectPlanesSSE41(const cv::Vec3f &origin, const float * const v[3], const float * const planes[4], size_t begin, size_t end, cv::Vec4f *results)
+{
+    const __m128 originv[3] = { _mm_set1_ps(origin[0]), _mm_set1_ps(origin[1]), _mm_set1_ps(origin[2]) };
+    const __m128 signMask = _mm_set1_ps(-0.f);
+
+    size_t i = begin;
+    for (; i + 4 <= end; i += 4) {
+        __m128 vv[3];
+        __m128 n_dot_v = _mm_setzero_ps();
+        for (int k=0; k<3; ++k) {
+            vv[k] = _mm_loadu_ps(v[k] + i);
+            n_dot_v = _mm_add_ps(n_dot_v, _mm_mul_ps(_mm_loadu_ps(planes[k] + i), vv[k]));
+        }
+
+        /// -k / (n . v)
+        __m128 t = _mm_div_ps(_mm_xor_ps(_mm_loadu_ps(planes[3] + i), signMask), n_dot_v);
+
+        __m128 point[3];
+        for (int k=0; k<3; ++k) {
+            point[k] = _mm_add_ps(originv[k], _mm_mul_ps(t, vv[k]));
+        }
+
+        /// from components to (x, y, z, t) for each line
+        _MM_TRANSPOSE4_PS(point[0], point[1], point[2], t);
+        _mm_storeu_ps(&results[i][0], point[0]);
+        _mm_storeu_ps(&results[i+1][0], point[1]);
+        _mm_storeu_ps(&results[i+2][0], point[2]);
+        _mm_storeu_ps(&results[i+3][0], t);
+    }
+
+    intersectPlanesScalar(origin, v, planes, i, end, results);
+}
+
+Z3D_TARGET_AVX2_FMA
+void intersectPlanesAVX2(const cv::Vec3f &origin, const float * const v[3], const float * const planes[4], size_t begin, size_t end, cv::Vec4f *results)
+{
+    const __m256 originv[3] = { _mm256_set1_ps(origin[0]), _mm256_set1_ps(origin[1]), _mm256_set1_ps(origin[2]) };
+    const __m256 signMask = _mm256_set1_ps(-0.f);
+
+    size_t i = begin;
+    for (; i + 8 <= end; i += 8) {
+        const __m256 vx = _mm256_loadu_ps(v[0] + i);
+        const __m256 vy = _mm256_loadu_ps(v[1] + i);
+        const __m256 vz = _mm256_loadu_ps(v[2] + i);
+
+        /// n . v as a chain of fused multiply-adds
+        const __m256 n_dot_v = _mm256_fmadd_ps(_mm256_loadu_ps(planes[2] + i), vz,
+                                               _mm256_fmadd_ps(_mm256_loadu_ps(planes[1] + i), vy,
+                                                               _mm256_mul_ps(_mm256_loadu_ps(planes[0] + i), vx)));
+        const __m256 t = _mm256_div_ps(_mm256_xor_ps(_mm256_loadu_ps(planes[3] + i), signMask), n_dot_v);
+
+        const __m256 x = _mm256_fmadd_ps(t, vx, originv[0]);
+        const __m256 y = _mm256_fmadd_ps(t, vy, originv[1]);
+        const __m256 z = _mm256_fmadd_ps(t, vz, originv[2]);
+
+        /// from components to (x, y, z, t), one 128 bit half at a time
+        __m128 lo[4] = { _mm256_castps256_ps128(x), _mm256_castps256_ps128(y), _mm256_castps256_ps128(z), _mm256_castps256_ps128(t) };
+        __m128 hi[4] = { _mm256_extractf128_ps(x, 1), _mm256_extractf128_ps(y, 1), _mm256_extractf128_ps(z, 1), _mm256_extractf128_ps(t, 1) };
+        _MM_TRANSPOSE4_PS(lo[0], lo[1], lo[2], lo[3]);
+        _MM_TRANSPOSE4_PS(hi[0], hi[1], hi[2], hi[3]);
+        for (int k=0; k<4; ++k) {
+            _mm_storeu_ps(&results[i+k][0], lo[k]);
+            _mm_storeu_ps(&results[i+4+k][0], hi[k]);
+        }
+    }
+
+    intersectPlanesSSE41(origin, v, planes, i, end, results);
+}
+
+#endif // Z3D_SIMD_X86
+
+IntersectPlanesFunc intersectPlanesKernel()
+{
+    static const IntersectPlanesFunc kernel = []() -> IntersectPlanesFunc {
+#if defined(Z3D_SIMD_X86)
+        const SimdUtils::SimdLevel level = SimdUtils::bestSupportedLevel();
+        if (level >= SimdUtils::SimdAVX2 && SimdUtils::hasFma()) {
+            return &intersectPlanesAVX2;
+        }
+        if (level >= SimdUtils::SimdSSE41) {
+            return &intersectPlanesSSE41;
+        }
+#endif
+        return &intersectPlanesScalar;
+    }();
+
+    return kernel;
+}
+
+} // anonymous namespace
+
+void GeometryUtils::intersectLinesWithLines3D(const float * const q1[3], const float * const v1[3], const float * const q2[3], const float * const v2[3], size_t count, cv::Vec4f *results)
+{
+    intersectLinesKernel()(q1, v1, q2, v2, 0, count, results);
+}
+
+void GeometryUtils::intersectLinesWithPlanes3D(const cv::Vec3f &origin, const float * const v[3], const float * const planes[4], size_t count, cv::Vec4f *results)
+{
+    intersectPlanesKernel()(origin, v, planes, 0, count, results);
+}
+
+cv::Vec3d GeometryUtils::intersectLines3D(const cv::Vec3f *q, const cv::Vec3f *v, size_t count, double *maxDistance)
+{
+    /// sum of (I - v*v') * (p - q) = 0 for every line
+    cv::Matx33d A = cv::Matx33d::zeros();
+    cv::Vec3d b(0, 0, 0);
+    for (size_t i=0; i<count; ++i) {
+        const cv::Vec3d vi(v[i]);
+        const cv::Matx33d projection = cv::Matx33d::eye() - vi * vi.t();
+        A += projection;
+        b += projection * cv::Vec3d(q[i]);
+    }
+
+    if (std::fabs(cv::determinant(A)) < DBL_EPSILON) {
+        const double nan = std::numeric_limits<double>::quiet_NaN();
+        if (maxDistance) {
+            *maxDistance = nan;
+        }
+        return cv::Vec3d(nan, nan, nan);
+    }
+
+    const cv::Vec3d point = A.solve(b, cv::DECOMP_LU);
+
+    if (maxDistance) {
+        double distance = 0;
+        for (size_t i=0; i<count; ++i) {
+            const cv::Vec3d diff = point - cv::Vec3d(q[i]);
+            const double along = diff.dot(cv::Vec3d(v[i]));
+            distance = std::max(distance, diff.dot(diff) - along * along);
+        }
+        *maxDistance = distance;
+    }
+
+    return point;
+}
+
 } // namespace Z3D
@@ -49,6 +49,69 @@ Z3D_STRUCTUREDLIGHT_SHARED_EXPORT cv::Vec3d intersectLineWithLine3D(const cv::Ve
                                                                     const cv::Vec3d &v2,
                                                                     double *distance = nullptr);
 
+/**
+ * @brief GeometryUtils::intersectLinesWithLines3D
+ * Same as intersectLineWithLine3D for count pairs of lines at once, in single
+ * precision and using SIMD instructions when available.
+ * Lines are given by component (i.e. q1[0] has the x coordinate of every q1),
+ * so several of them can be loaded at a time. Direction vectors must be unit
+ * vectors.
+ *
+ * @param q1 points on the first lines (x, y and z arrays)
+ * @param v1 directions of the first lines
+ * @param q2 points on the second lines
+ * @param v2 directions of the second lines
+ * @param count number of pairs of lines
+ * @param results for every pair the approximate intersection and the squared
+ * minimum distance between the lines, as (x, y, z, distance). Parallel lines
+ * give NaN or infinite values
+ */
+Z3D_STRUCTUREDLIGHT_SHARED_EXPORT void intersectLinesWithLines3D(const float * const q1[3],
+                                                                 const float * const v1[3],
+                                                                 const float * const q2[3],
+                                                                 const float * const v2[3],
+                                                                 size_t count,
+                                                                 cv::Vec4f *results);
+
+/**
+ * @brief GeometryUtils::intersectLinesWithPlanes3D
+ * Intersects count lines that start at the same point with one plane each, in
+ * single precision and using SIMD instructions when available.
+ * Planes are given relative to origin, as n . (p - origin) + k = 0, so each
+ * intersection is origin + t * v with t = -k / (n . v).
+ *
+ * @param origin point shared by all the lines
+ * @param v directions of the lines (x, y and z arrays)
+ * @param planes normal (planes[0], planes[1], planes[2]) and k (planes[3]) of
+ * the plane of each line
+ * @param count number of lines
+ * @param results for every line the intersection and the distance along the
+ * line (t), as (x, y, z, t). Lines parallel to their plane or with NaN
+ * components give NaN or infinite values
+ */
+Z3D_STRUCTUREDLIGHT_SHARED_EXPORT void intersectLinesWithPlanes3D(const cv::Vec3f &origin,
+                                                                  const float * const v[3],
+                                                                  const float * const planes[4],
+                                                                  size_t count,
+                                                                  cv::Vec4f *results);
+
+/**
+ * @brief GeometryUtils::intersectLines3D
+ * Finds the 3D point closest to several 3D lines (least squares), i.e. the one
+ * that minimizes the sum of the squared distances to all of them.
+ * Direction vectors must be unit vectors.
+ *
+ * @param q points on each line
+ * @param v directions of each line
+ * @param count number of lines, at least 2
+ * @param maxDistance the largest squared distance from the point to a line
+ * @return approximate intersection of the lines, NaN if they are parallel
+ */
+Z3D_STRUCTUREDLIGHT_SHARED_EXPORT cv::Vec3d intersectLines3D(const cv::Vec3f *q,
+                                                             const cv::Vec3f *v,
+                                                             size_t count,
+                                                             double *maxDistance = nullptr);
+
 } // namespace GeometryUtils
 
 } // namespace Z3D
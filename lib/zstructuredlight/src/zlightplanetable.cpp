@@ -0,0 +1,331 @@
+//
+// Z3D - A structured light 3D scanner
+// Copyright (C) 2013-2016 Nicolas Ulrich <nikolaseu@gmail.com>
+//
+// This file is part of Z3D.
+//
+// Z3D is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Z3D is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Z3D.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+#include "zlightplanetable.h"
+
+#include "zcoderowindex.h"
+#include "zdecodedpattern.h"
+#include "zgeometryutils.h"
+#include "zparallelutils.h"
+#include "zsimplepointcloud.h"
+
+#include <QDebug>
+
+#include <opencv2/core.hpp> // eigen, split
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace Z3D
+{
+
+namespace
+{
+
+/// rows of each band, every band is triangulated in its own buffers
+constexpr int BAND_ROWS = 16;
+
+/// codes are used as indexes, anything larger is not a projector code
+constexpr float MAX_CODE = 65535.f;
+
+/// the rays of a plane must span it, i.e. not all be (almost) the same ray
+constexpr double MIN_EIGENVALUE_RATIO = 1e-9;
+
+/// sum of d * d' of the rays of one code, only the upper triangle
+struct RayMoments
+{
+    double xx = 0, xy = 0, xz = 0, yy = 0, yz = 0, zz = 0;
+    size_t count = 0;
+
+    void add(const cv::Vec3f &d)
+    {
+        xx += double(d[0]) * d[0];
+        xy += double(d[0]) * d[1];
+        xz += double(d[0]) * d[2];
+        yy += double(d[1]) * d[1];
+        yz += double(d[1]) * d[2];
+        zz += double(d[2]) * d[2];
+        ++count;
+    }
+};
+
+} // anonymous namespace
+
+ZLightPlaneTable::ZLightPlaneTable()
+{
+
+}
+
+bool ZLightPlaneTable::build(const ZRayTriangulator::CameraRays &cameraRays,
+                             const ZRayTriangulator::CameraRays &projectorRays,
+                             const cv::Mat &projectorDecodedImage)
+{
+    for (auto &coefficients : m_planes) {
+        coefficients.clear();
+    }
+
+    if (cameraRays.empty() || projectorRays.empty()) {
+        qWarning() << "camera and projector rays are required";
+        return false;
+    }
+
+    if ((projectorDecodedImage.type() != CV_32FC1 && projectorDecodedImage.type() != CV_16UC1)
+            || projectorDecodedImage.size() != projectorRays.directions.size()) {
+        qWarning() << "projector decoded image doesn't have the calibrated size";
+        return false;
+    }
+
+    /// every projector pixel contributes to the plane of its code
+    std::vector<RayMoments> moments;
+    std::vector<float> buffer;
+    for (int y=0; y<projectorDecodedImage.rows; ++y) {
+        const float *codes = ZDecodedPattern::codeRow(projectorDecodedImage, y, 0, projectorDecodedImage.cols, buffer);
+        const cv::Vec3f *directions = projectorRays.directions.ptr<cv::Vec3f>(y);
+        for (int x=0; x<projectorDecodedImage.cols; ++x) {
+            const float code = codes[x];
+            if (code == ZDecodedPattern::NO_VALUE || !(code >= 0.f && code <= MAX_CODE) || std::isnan(directions[x][0])) {
+                continue;
+            }
+            const size_t index = size_t(std::lround(code));
+            if (index >= moments.size()) {
+                moments.resize(index + 1);
+            }
+            moments[index].add(directions[x]);
+        }
+    }
+
+    /// all the planes go through the projector center, the normal is the
+    /// direction closest to perpendicular to all the rays, i.e. the
+    /// eigenvector of the smallest eigenvalue of sum(d * d')
+    const cv::Vec3d baseline = cv::Vec3d(cameraRays.origin) - cv::Vec3d(projectorRays.origin);
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    size_t validCount = 0;
+    cv::Vec3d previousNormal(0, 0, 0);
+    for (auto &coefficients : m_planes) {
+        coefficients.assign(moments.size(), nan);
+    }
+    for (size_t code=0; code<moments.size(); ++code) {
+        const RayMoments &m = moments[code];
+        if (m.count < 2) {
+            continue;
+        }
+
+        const cv::Matx33d covariance(m.xx, m.xy, m.xz,
+                                     m.xy, m.yy, m.yz,
+                                     m.xz, m.yz, m.zz);
+        cv::Matx31d eigenvalues;
+        cv::Matx33d eigenvectors;
+        cv::eigen(covariance, eigenvalues, eigenvectors);
+        if (!(eigenvalues(1) > MIN_EIGENVALUE_RATIO * eigenvalues(0))) {
+            continue;
+        }
+
+        /// the same orientation for all of them, so neighbour planes can be
+        /// interpolated
+        cv::Vec3d normal(eigenvectors(2, 0), eigenvectors(2, 1), eigenvectors(2, 2));
+        if (normal.dot(previousNormal) < 0) {
+            normal = -normal;
+        }
+        previousNormal = normal;
+
+        m_planes[0][code] = float(normal[0]);
+        m_planes[1][code] = float(normal[1]);
+        m_planes[2][code] = float(normal[2]);
+        m_planes[3][code] = float(normal.dot(baseline));
+        ++validCount;
+    }
+
+    qDebug() << "fitted" << validCount << "light planes for" << moments.size() << "codes";
+
+    if (validCount < 1) {
+        for (auto &coefficients : m_planes) {
+            coefficients.clear();
+        }
+        return false;
+    }
+
+    m_origin = cameraRays.origin;
+    cv::split(cameraRays.directions, m_directions);
+
+    return true;
+}
+
+bool ZLightPlaneTable::empty() const
+{
+    return m_planes[0].empty();
+}
+
+size_t ZLightPlaneTable::codeCount() const
+{
+    return m_planes[0].size();
+}
+
+cv::Vec4f ZLightPlaneTable::plane(size_t code) const
+{
+    if (code >= codeCount()) {
+        const float nan = std::numeric_limits<float>::quiet_NaN();
+        return cv::Vec4f(nan, nan, nan, nan);
+    }
+
+    return cv::Vec4f(m_planes[0][code], m_planes[1][code], m_planes[2][code], m_planes[3][code]);
+}
+
+ZPointCloudPtr ZLightPlaneTable::triangulate(const cv::Mat &colorImage, const cv::Mat &decodedImage, const cv::Rect &roi, bool organized) const
+{
+    if (empty()) {
+        qWarning() << "light planes are not available";
+        return nullptr;
+    }
+
+    const cv::Size imageSize = m_directions[0].size();
+    if (decodedImage.size() != imageSize) {
+        qWarning() << "decoded image doesn't have the calibrated size";
+        return nullptr;
+    }
+
+    if (decodedImage.type() != CV_32FC1 && decodedImage.type() != CV_16UC1) {
+        qWarning() << "unkwnown image type:" << decodedImage.type();
+        return nullptr;
+    }
+
+    const cv::Rect imageRect(cv::Point(), imageSize);
+    const cv::Rect rect = roi.empty() ? imageRect : roi & imageRect;
+    if (rect.empty()) {
+        qDebug() << "region of interest is empty, nothing to triangulate";
+        return nullptr;
+    }
+
+    const bool hasColor = colorImage.type() == CV_8UC1 && colorImage.size() == imageSize;
+
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    ZSimplePointCloud::PointVector grid;
+    if (organized) {
+        grid.assign(size_t(imageSize.width) * size_t(imageSize.height), ZSimplePointCloud::PointType(nan, nan, nan, 0.f));
+    }
+
+    const int bandCount = (rect.height + BAND_ROWS - 1) / BAND_ROWS;
+    std::vector<ZSimplePointCloud::PointVector> bandPoints(size_t(bandCount));
+    const size_t lastCode = codeCount() - 1;
+
+    ParallelUtils::forEachTile(bandCount, [&](int band) {
+        const int rowBegin = rect.y + band * BAND_ROWS;
+        const int rowEnd = std::min(rowBegin + BAND_ROWS, rect.y + rect.height);
+        const size_t width = size_t(rect.width);
+
+        std::vector<float> codes(width);
+        std::vector<float> buffer;
+        std::vector<float> planes[4];
+        for (auto &coefficients : planes) {
+            coefficients.resize(width);
+        }
+        std::vector<cv::Vec4f> results(width);
+        auto &points = bandPoints[size_t(band)];
+
+        for (int y=rowBegin; y<rowEnd; ++y) {
+            const float *decoded = ZDecodedPattern::codeRow(decodedImage, y, rect.x, rect.width, buffer);
+            ZCodeRowIndex::subPixelCodes(decoded, rect.width, codes.data());
+
+            /// plane of every pixel, NaN if there's none. Fractional codes
+            /// interpolate the planes of both neighbour codes (they all go
+            /// through the projector center, so it's also a plane between them)
+            for (size_t i=0; i<width; ++i) {
+                float code = codes[i];
+                if (std::isnan(code)) {
+                    /// not interpolated (i.e. isolated run), use the fringe as is
+                    code = decoded[i] == ZDecodedPattern::NO_VALUE ? nan : decoded[i];
+                }
+
+                const float code0 = std::floor(code);
+                if (!(code0 >= 0.f && code0 <= float(lastCode))) {
+                    for (auto &coefficients : planes) {
+                        coefficients[i] = nan;
+                    }
+                    continue;
+                }
+
+                const size_t index = size_t(code0);
+                const float fraction = code - code0;
+                for (int k=0; k<4; ++k) {
+                    const float value0 = m_planes[k][index];
+                    planes[k][i] = fraction > 0.f
+                            ? value0 + fraction * (m_planes[k][std::min(index + 1, lastCode)] - value0)
+                            : value0;
+                }
+            }
+
+            const float *directions[3] = { m_directions[0].ptr<float>(y) + rect.x,
+                                           m_directions[1].ptr<float>(y) + rect.x,
+                                           m_directions[2].ptr<float>(y) + rect.x };
+            const float *planeData[4] = { planes[0].data(), planes[1].data(), planes[2].data(), planes[3].data() };
+            GeometryUtils::intersectLinesWithPlanes3D(m_origin, directions, planeData, width, results.data());
+
+            const uint8_t *colorData = hasColor ? colorImage.ptr<uint8_t>(y) + rect.x : nullptr;
+            for (size_t i=0; i<width; ++i) {
+                const cv::Vec4f &result = results[i];
+                /// behind the camera, parallel to the plane or NaN
+                if (!(result[3] > 0.f) || std::isinf(result[3])) {
+                    continue;
+                }
+
+                const ZSimplePointCloud::PointType point(result[0], result[1], result[2],
+                                                         hasColor ? ZSimplePointCloud::grayToPackedColor(colorData[i]) : 0.f);
+                if (organized) {
+                    grid[size_t(y) * size_t(imageSize.width) + size_t(rect.x) + i] = point;
+                } else {
+                    points.push_back(point);
+                }
+            }
+        }
+    });
+
+    if (organized) {
+        auto cloud = new ZSimplePointCloud(std::move(grid), unsigned(imageSize.width), unsigned(imageSize.height));
+        qDebug() << "triangulated" << cloud->validPointCount() << "points";
+        if (cloud->validPointCount() < 1) {
+            delete cloud;
+            return nullptr;
+        }
+        return ZPointCloudPtr(cloud);
+    }
+
+    size_t pointCount = 0;
+    for (const auto &points : bandPoints) {
+        pointCount += points.size();
+    }
+
+    qDebug() << "triangulated" << pointCount << "points";
+
+    if (pointCount < 1) {
+        return nullptr;
+    }
+
+    ZSimplePointCloud::PointVector points;
+    points.reserve(pointCount);
+    for (auto &band : bandPoints) {
+        points.insert(points.end(), band.cbegin(), band.cend());
+        ZSimplePointCloud::PointVector().swap(band);
+    }
+
+    return ZPointCloudPtr(new ZSimplePointCloud(std::move(points)));
+}
+
+} // namespace Z3D
@@ -0,0 +1,81 @@
+/* * Z3D - A structured light 3D scanner
+ * Copyright (C) 2013-2016 Nicolas Ulrich <nikolaseu@gmail.com>
+ *
+ * This file is part of Z3D.
+ *
+ * Z3D is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Z3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Z3D.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "zstructuredlight_global.h"
+
+#include "zpointcloud_fwd.h"
+#include "zraytriangulator.h"
+
+#include <opencv2/core/mat.hpp>
+
+#include <vector>
+
+namespace Z3D
+{
+
+/// Triangulates a camera against a projector using one plane of light per
+/// code: every projector pixel with the same code lights the same plane, so a
+/// camera pixel with that code is the intersection of its ray with the plane.
+/// The planes are fitted once, from the projector rays and its decoded image,
+/// and then each pixel only needs a lookup and a few multiply-adds (no search
+/// for correspondences at all)
+class Z3D_STRUCTUREDLIGHT_SHARED_EXPORT ZLightPlaneTable
+{
+public:
+    ZLightPlaneTable();
+
+    /// fits the plane of every (integer) code of projectorDecodedImage to the
+    /// rays of the projector pixels with that code. Planes are stored relative
+    /// to the camera center, and the camera directions by component, so the
+    /// triangulation reads everything sequentially.
+    /// Returns false (and the table is empty) if there's no valid plane
+    bool build(const ZRayTriangulator::CameraRays &cameraRays,
+               const ZRayTriangulator::CameraRays &projectorRays,
+               const cv::Mat &projectorDecodedImage);
+
+    bool empty() const;
+
+    /// number of codes in the table, including the ones without a valid plane
+    size_t codeCount() const;
+
+    /// plane of code as (nx, ny, nz, k), with n . (p - camera center) + k = 0,
+    /// NaN if it's not known
+    cv::Vec4f plane(size_t code) const;
+
+    /// intersects the ray of every decoded pixel of the camera with the plane of
+    /// its code (interpolated between the planes of the nearest integer codes).
+    /// roi is the decoded region of the image, empty to use the whole image.
+    /// The decoded image can be floating or fixed point (see ZDecodedPattern).
+    /// Organized clouds have one point per pixel of the camera
+    ZPointCloudPtr triangulate(const cv::Mat &colorImage,
+                               const cv::Mat &decodedImage,
+                               const cv::Rect &roi,
+                               bool organized) const;
+
+private:
+    cv::Vec3f m_origin;
+    /// nx, ny, nz and k of each code
+    std::vector<float> m_planes[4];
+    /// x, y and z components of the camera directions, CV_32FC1
+    cv::Mat m_directions[3];
+};
+
+} // namespace Z3D
@@ -0,0 +1,97 @@
+//
+// Z3D - A structured light 3D scanner
+// Copyright (C) 2013-2016 Nicolas Ulrich <nikolaseu@gmail.com>
+//
+// This file is part of Z3D.
+//
+// Z3D is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Z3D is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Z3D.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "zparallelutils.h"
+
+#include <QAtomicInt>
+#include <QFuture>
+#include <QThread>
+#include <QtConcurrentRun>
+
+#include <algorithm>
+#include <vector>
+
+namespace Z3D
+{
+
+int ParallelUtils::threadCount(int requestedThreads)
+{
+    if (requestedThreads > 0) {
+        return requestedThreads;
+    }
+
+    return std::max(1, QThread::idealThreadCount());
+}
+
+void ParallelUtils::forEachTile(int tileCount, const std::function<void(int)> &func, int maxThreads)
+{
+    if (tileCount < 1) {
+        return;
+    }
+
+    const int threads = std::min(tileCount, threadCount(maxThreads));
+
+    QAtomicInt nextTile(0);
+    const auto worker = [&]() {
+        int tile;
+        while ((tile = nextTile.fetchAndAddRelaxed(1)) < tileCount) {
+            func(tile);
+        }
+    };
+
+    /// the current thread is one of the workers
+    std::vector< QFuture<void> > futures;
+    futures.reserve(size_t(threads - 1));
+    for (int i=1; i<threads; ++i) {
+        futures.push_back(QtConcurrent::run(worker));
+    }
+
+    worker();
+
+    /// if a worker didn't even start (i.e. the pool is busy) it runs here
+    /// and it will find there's nothing left to do
+    for (auto &future : futures) {
+        future.waitForFinished();
+    }
+}
+
+void ParallelUtils::forEachRowBand(const std::vector<int> &imageRows, const std::function<void (int, int, int)> &func, int maxThreads, int bandRows)
+{
+    struct RowBand {
+        int image;
+        int rowBegin;
+        int rowEnd;
+    };
+
+    std::vector<RowBand> bands;
+    for (size_t image=0; image<imageRows.size(); ++image) {
+        const int rows = imageRows[image];
+        for (int rowBegin=0; rowBegin<rows; rowBegin+=bandRows) {
+            bands.push_back({ int(image), rowBegin, std::min(rowBegin + bandRows, rows) });
+        }
+    }
+
+    forEachTile(int(bands.size()), [&](int tile) {
+        const RowBand &band = bands[size_t(tile)];
+        func(band.image, band.rowBegin, band.rowEnd);
+    }, maxThreads);
+}
+
+} // namespace Z3D
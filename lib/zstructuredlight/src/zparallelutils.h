@@ -0,0 +1,76 @@
+/* * Z3D - A structured light 3D scanner
+ * Copyright (C) 2013-2016 Nicolas Ulrich <nikolaseu@gmail.com>
+ *
+ * This file is part of Z3D.
+ *
+ * Z3D is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Z3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Z3D.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include "zstructuredlight_global.h"
+
+#include <functional>
+#include <vector>
+
+namespace Z3D
+{
+
+namespace ParallelUtils
+{
+
+/**
+ * @brief ParallelUtils::threadCount
+ * Number of threads to use for a given setting, where 0 (or less) means
+ * automatic, i.e. one per core.
+ */
+Z3D_STRUCTUREDLIGHT_SHARED_EXPORT int threadCount(int requestedThreads = 0);
+
+/**
+ * @brief ParallelUtils::forEachTile
+ * Calls func for every tile index in [0, tileCount), using up to maxThreads
+ * threads (0 means automatic). The calling thread also processes tiles.
+ * Tiles are not assigned in advance, every thread takes the next pending one
+ * when it's done with the previous, so faster threads (or cheaper tiles) don't
+ * leave cores idle. Returns when every tile was processed.
+ *
+ * @param tileCount number of tiles
+ * @param func function to call for each tile, it must be thread safe
+ * @param maxThreads maximum number of threads to use
+ */
+Z3D_STRUCTUREDLIGHT_SHARED_EXPORT void forEachTile(int tileCount,
+                                                   const std::function<void(int)> &func,
+                                                   int maxThreads = 0);
+
+/**
+ * @brief ParallelUtils::forEachRowBand
+ * Splits several images in bands of rows and processes all of them as
+ * independent tiles, see forEachTile. Useful to process all the cameras
+ * at the same time, even if there are more cores than cameras.
+ *
+ * @param imageRows number of rows of each image
+ * @param func function to call for each band with the image index and the
+ * rows range [rowBegin, rowEnd), it must be thread safe
+ * @param maxThreads maximum number of threads to use
+ * @param bandRows maximum number of rows of each band
+ */
+Z3D_STRUCTUREDLIGHT_SHARED_EXPORT void forEachRowBand(const std::vector<int> &imageRows,
+                                                      const std::function<void(int image, int rowBegin, int rowEnd)> &func,
+                                                      int maxThreads = 0,
+                                                      int bandRows = 32);
+
+} // namespace ParallelUtils
+
+} // namespace Z3D
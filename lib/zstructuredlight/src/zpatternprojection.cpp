@@ -20,11 +20,15 @@
 
 #include "zpatternprojection.h"
 
+#include "zdecodedpattern.h"
+
 namespace Z3D
 {
 
 ZPatternProjection::ZPatternProjection(QObject *parent)
     : QObject(parent)
+    , m_autoRoi(false)
+    , m_floatDecodedImages(false)
 {
 
 }
@@ -34,4 +38,48 @@ ZPatternProjection::~ZPatternProjection()
 
 }
 
+cv::Rect ZPatternProjection::roi() const
+{
+    return m_roi;
+}
+
+void ZPatternProjection::setRoi(const cv::Rect &roi)
+{
+    m_roi = roi;
+}
+
+bool ZPatternProjection::autoRoi() const
+{
+    return m_autoRoi;
+}
+
+void ZPatternProjection::setAutoRoi(bool autoRoi)
+{
+    m_autoRoi = autoRoi;
+}
+
+bool ZPatternProjection::floatDecodedImages() const
+{
+    return m_floatDecodedImages;
+}
+
+void ZPatternProjection::setFloatDecodedImages(bool floatDecodedImages)
+{
+    m_floatDecodedImages = floatDecodedImages;
+}
+
+int ZPatternProjection::decodedImageType(int maxCode) const
+{
+    return m_floatDecodedImages || maxCode > ZDecodedPattern::FIXED_POINT_MAX_CODE
+            ? CV_32FC1
+            : CV_16UC1;
+}
+
+void ZPatternProjection::onImagesAcquired(std::vector<ZCameraImagePtr> images, QString id)
+{
+    /// nothing to do by default, images are processed when acquisition finishes
+    Q_UNUSED(images)
+    Q_UNUSED(id)
+}
+
 } // namespace Z3D
@@ -27,6 +27,8 @@
 
 #include <QObject>
 
+#include <opencv2/core/types.hpp>
+
 namespace Z3D
 {
 
@@ -40,8 +42,24 @@ public:
 
     virtual const std::vector<ZSettingsItemPtr> &settings() = 0;
 
+    /// region of the camera images to decode, empty to use the whole image
+    cv::Rect roi() const;
+    void setRoi(const cv::Rect &roi);
+
+    /// reduce the region to decode to the pixels lit by the projector, i.e.
+    /// the bounding box of the mask computed from the all white/all black images
+    bool autoRoi() const;
+    void setAutoRoi(bool autoRoi);
+
+    /// decode to floating point (CV_32FC1) images instead of the default
+    /// fixed point (CV_16UC1) ones, see ZDecodedPattern
+    bool floatDecodedImages() const;
+    void setFloatDecodedImages(bool floatDecodedImages);
+
 signals:
-    void prepareAcquisition(QString acquisitionId);
+    /// burstFrameCount is the number of frames that will be acquired, to
+    /// acquire them as a burst, or 0 to acquire them one at a time
+    void prepareAcquisition(QString acquisitionId, int burstFrameCount);
     void acquireSingle(QString id);
     void finishAcquisition();
 
@@ -52,6 +70,20 @@ signals:
 public slots:
     virtual void beginScan() = 0;
     virtual void processImages(std::vector< std::vector<Z3D::ZCameraImagePtr> > acquiredImages, QString acquisitionId) = 0;
+
+    /// called as soon as each frame is acquired (one image per camera), before
+    /// processImages. Allows to start decoding while the acquisition continues
+    virtual void onImagesAcquired(std::vector<Z3D::ZCameraImagePtr> images, QString id);
+
+protected:
+    /// type of the decoded images for codes up to maxCode, floating point if
+    /// requested or if they don't fit in fixed point
+    int decodedImageType(int maxCode) const;
+
+private:
+    cv::Rect m_roi;
+    bool m_autoRoi;
+    bool m_floatDecodedImages;
 };
 
 } // namespace Z3D
@@ -24,16 +24,31 @@
 
 #include <QMetaType>
 
+#include <atomic>
+
 namespace Z3D
 {
 
 static int z3dDecodedPatternPtrTypeId = qRegisterMetaType<Z3D::ZProjectedPatternPtr>("Z3D::ZProjectedPatternPtr");
 
 ZProjectedPattern::ZProjectedPattern(cv::Mat decodedImage,
-                                     std::map<int, std::vector<cv::Vec2f> > fringePointsList)
-    : ZStructuredLightPattern(decodedImage, fringePointsList)
+                                     ZFringePoints fringePoints,
+                                     uint64_t decodedImageId)
+    : ZStructuredLightPattern(decodedImage, std::move(fringePoints))
+    , m_decodedImageId(decodedImageId)
 {
 
 }
 
+uint64_t ZProjectedPattern::decodedImageId() const
+{
+    return m_decodedImageId;
+}
+
+uint64_t ZProjectedPattern::newDecodedImageId()
+{
+    static std::atomic<uint64_t> lastId(0);
+    return ++lastId;
+}
+
 } // namespace Z3D
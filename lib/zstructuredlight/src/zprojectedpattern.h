@@ -23,6 +23,8 @@
 
 #include "zstructuredlightpattern.h"
 
+#include <cstdint>
+
 namespace Z3D
 {
 
@@ -30,7 +32,18 @@ struct Z3D_STRUCTUREDLIGHT_SHARED_EXPORT ZProjectedPattern : public ZStructuredL
 {
 public:
     explicit ZProjectedPattern(cv::Mat decodedImage,
-                               std::map<int, std::vector<cv::Vec2f> > fringePointsList);
+                               ZFringePoints fringePoints,
+                               uint64_t decodedImageId = 0);
+
+    /// identifies the contents of the decoded image, patterns with the same
+    /// (non zero) id have the same decoded image. 0 means unknown
+    uint64_t decodedImageId() const;
+
+    /// a new id, for a decoded image that is different from all the previous
+    static uint64_t newDecodedImageId();
+
+private:
+    uint64_t m_decodedImageId;
 };
 
 } // namespace Z3D
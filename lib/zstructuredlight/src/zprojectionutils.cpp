@@ -0,0 +1,91 @@
+//
+// Z3D - A structured light 3D scanner
+// Copyright (C) 2013-2016 Nicolas Ulrich <nikolaseu@gmail.com>
+//
+// This file is part of Z3D.
+//
+// Z3D is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Z3D is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Z3D.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "zprojectionutils.h"
+
+#include <QEventLoop>
+#include <QPointer>
+#include <QQuickWindow>
+#include <QScreen>
+#include <QTimer>
+
+#include <atomic>
+#include <cmath>
+#include <memory>
+
+namespace Z3D
+{
+
+bool ProjectionUtils::waitForProjectedFrame(QQuickWindow *window, int timeoutMs)
+{
+    /// a frame that was already being rendered when the pattern changed could
+    /// still show the previous one, so we wait for the first frame that was
+    /// synchronized after the change to be swapped.
+    /// The render thread can still be running a slot after we return (there
+    /// is no way to wait for it), so it only touches this shared state and
+    /// the event loop is only accessed from this thread
+    struct FrameState {
+        std::atomic<bool> synchronized { false };
+        std::atomic<bool> swapped { false };
+        QPointer<QEventLoop> eventLoop;
+    };
+
+    QEventLoop eventLoop;
+    auto state = std::make_shared<FrameState>();
+    state->eventLoop = &eventLoop;
+
+    /// these are emitted from the render thread when using the threaded render loop
+    const QMetaObject::Connection synchronizedConnection =
+            QObject::connect(window, &QQuickWindow::afterSynchronizing,
+                             window, [state](){ state->synchronized = true; },
+                             Qt::DirectConnection);
+    const QMetaObject::Connection swappedConnection =
+            QObject::connect(window, &QQuickWindow::frameSwapped,
+                             window, [state, window](){
+        if (state->synchronized && !state->swapped.exchange(true)) {
+            /// runs in the window's thread, i.e. this one
+            QMetaObject::invokeMethod(window, [state](){
+                if (state->eventLoop) {
+                    state->eventLoop->quit();
+                }
+            }, Qt::QueuedConnection);
+        }
+    }, Qt::DirectConnection);
+
+    QTimer::singleShot(timeoutMs, &eventLoop, &QEventLoop::quit);
+
+    window->update();
+    eventLoop.exec();
+
+    QObject::disconnect(synchronizedConnection);
+    QObject::disconnect(swappedConnection);
+
+    return state->swapped;
+}
+
+int ProjectionUtils::settleTimeMs(const QQuickWindow *window, int settleFrames)
+{
+    const QScreen *screen = window->screen();
+    const qreal refreshRate = (screen && screen->refreshRate() > 1.) ? screen->refreshRate() : 60.;
+
+    return int(std::ceil(settleFrames * 1000. / refreshRate));
+}
+
+} // namespace Z3D
@@ -0,0 +1,54 @@
+/* * Z3D - A structured light 3D scanner
+ * Copyright (C) 2013-2016 Nicolas Ulrich <nikolaseu@gmail.com>
+ *
+ * This file is part of Z3D.
+ *
+ * Z3D is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Z3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Z3D.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include "zstructuredlight_global.h"
+
+class QQuickWindow;
+
+namespace Z3D
+{
+
+namespace ProjectionUtils
+{
+
+/**
+ * @brief ProjectionUtils::waitForProjectedFrame
+ * Waits (running an event loop) until the window shows a frame that was
+ * synchronized after calling it, i.e. the last changes are on screen.
+ * Safe to use with the threaded render loop.
+ *
+ * @param window the window used to project the patterns
+ * @param timeoutMs maximum time to wait, in milliseconds
+ * @return false if there was a timeout
+ */
+Z3D_STRUCTUREDLIGHT_SHARED_EXPORT bool waitForProjectedFrame(QQuickWindow *window, int timeoutMs);
+
+/**
+ * @brief ProjectionUtils::settleTimeMs
+ * Time needed to show settleFrames frames in the screen of the window, in
+ * milliseconds (60Hz is assumed if the refresh rate is unknown).
+ */
+Z3D_STRUCTUREDLIGHT_SHARED_EXPORT int settleTimeMs(const QQuickWindow *window, int settleFrames);
+
+} // namespace ProjectionUtils
+
+} // namespace Z3D
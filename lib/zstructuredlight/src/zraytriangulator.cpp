@@ -0,0 +1,651 @@
+//
+// Z3D - A structured light 3D scanner
+// Copyright (C) 2013-2016 Nicolas Ulrich <nikolaseu@gmail.com>
+//
+// This file is part of Z3D.
+//
+// Z3D is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Z3D is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Z3D.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "zraytriangulator.h"
+
+#include "zcameracalibration.h"
+#include "zcoderowindex.h"
+#include "zdecodedpattern.h"
+#include "zgeometryutils.h"
+#include "zparallelutils.h"
+#include "zsimplepointcloud.h"
+
+#include <QDebug>
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <limits>
+
+namespace Z3D
+{
+
+namespace
+{
+
+/// rows of each band, every band is matched and intersected in its own buffers
+constexpr int BAND_ROWS = 16;
+
+/// the coplanarity is almost linear along the epipolar curve, so the search
+/// usually needs one or two steps
+constexpr int MAX_EPIPOLAR_SEARCH_STEPS = 4;
+
+/// pairs of rays to intersect, stored by component for intersectLinesWithLines3D
+struct RayPairBatch
+{
+    std::vector<float> q1[3];
+    std::vector<float> v1[3];
+    std::vector<float> q2[3];
+    std::vector<float> v2[3];
+    std::vector<size_t> pixels;
+    std::vector<float> colors;
+
+    size_t size() const { return pixels.size(); }
+
+    void add(const cv::Vec3f &origin1, const cv::Vec3f &direction1,
+             const cv::Vec3f &origin2, const cv::Vec3f &direction2,
+             size_t pixel, float color)
+    {
+        for (int k=0; k<3; ++k) {
+            q1[k].push_back(origin1[k]);
+            v1[k].push_back(direction1[k]);
+            q2[k].push_back(origin2[k]);
+            v2[k].push_back(direction2[k]);
+        }
+        pixels.push_back(pixel);
+        colors.push_back(color);
+    }
+
+    void intersect(std::vector<cv::Vec4f> &results) const
+    {
+        const float *q1Data[3] = { q1[0].data(), q1[1].data(), q1[2].data() };
+        const float *v1Data[3] = { v1[0].data(), v1[1].data(), v1[2].data() };
+        const float *q2Data[3] = { q2[0].data(), q2[1].data(), q2[2].data() };
+        const float *v2Data[3] = { v2[0].data(), v2[1].data(), v2[2].data() };
+        results.resize(size());
+        GeometryUtils::intersectLinesWithLines3D(q1Data, v1Data, q2Data, v2Data, size(), results.data());
+    }
+};
+
+/// rows skipped at a time when looking for the first row with the code
+constexpr int PROBE_ROW_STEP = 8;
+
+/// pixels of each row that can look for the first row with the code (when
+/// there's no previous match to start from), so rows that are not seen by
+/// the other camera don't take forever
+constexpr int MAX_PROBES_PER_ROW = 16;
+
+/// finds the position of code in the rows of rect (indexes has one index per
+/// row) where its ray is coplanar with the baseline and the ray of the other
+/// camera, i.e. where normal . direction changes sign. Starts at row hint, or
+/// around it if probe is true and the code is not there
+bool findEpipolarMatch(const std::vector<ZCodeRowIndex> &indexes,
+                       const ZRayTriangulator::CameraRays &rays,
+                       const cv::Rect &rect,
+                       float code,
+                       const cv::Vec3f &normal,
+                       int hint,
+                       bool probe,
+                       float *x, float *y)
+{
+    if (rect.height < 2) {
+        return false;
+    }
+
+    const auto evaluate = [&](int row, float *column, float *value) {
+        if (!indexes[size_t(row)].findColumn(code, column)) {
+            return false;
+        }
+        *column += float(rect.x);
+        cv::Vec3f direction;
+        if (!rays.directionAt(*column, float(rect.y + row), &direction)) {
+            return false;
+        }
+        *value = normal.dot(direction);
+        return true;
+    };
+
+    const float lastRow = float(rect.height - 2);
+    int row = std::max(0, std::min(hint - rect.y, rect.height - 2));
+    for (int step=0; step<MAX_EPIPOLAR_SEARCH_STEPS; ++step) {
+        float column0, value0, column1, value1;
+        if (!evaluate(row, &column0, &value0) || !evaluate(row + 1, &column1, &value1)) {
+            if (!probe) {
+                return false;
+            }
+
+            /// look for the code in rows further and further away
+            probe = false;
+            bool found = false;
+            for (int offset=PROBE_ROW_STEP; !found && (row - offset >= 0 || row + offset <= rect.height - 2); offset += PROBE_ROW_STEP) {
+                for (const int probeRow : { row - offset, row + offset }) {
+                    if (probeRow >= 0 && probeRow <= rect.height - 2
+                            && evaluate(probeRow, &column0, &value0) && evaluate(probeRow + 1, &column1, &value1)) {
+                        row = probeRow;
+                        found = true;
+                        break;
+                    }
+                }
+            }
+            if (!found) {
+                return false;
+            }
+        }
+
+        const float delta = value0 - value1;
+        if (value0 == 0.f || (value0 < 0.f) != (value1 < 0.f)) {
+            const float t = value0 == 0.f ? 0.f : value0 / delta;
+            *x = column0 + t * (column1 - column0);
+            *y = float(rect.y + row) + t;
+            return true;
+        }
+
+        if (delta == 0.f) {
+            return false;
+        }
+
+        /// almost linear between rows, jump to where it would be zero
+        const int nextRow = int(std::floor(std::max(0.f, std::min(float(row) + value0 / delta, lastRow))));
+        if (nextRow == row) {
+            return false;
+        }
+        row = nextRow;
+    }
+
+    return false;
+}
+
+/// the decoded region of an image, the whole image if roi is empty
+cv::Rect decodedRect(const cv::Rect &roi, const cv::Size &imageSize)
+{
+    const cv::Rect imageRect(cv::Point(), imageSize);
+    return roi.empty() ? imageRect : roi & imageRect;
+}
+
+/// floating or fixed point, see ZDecodedPattern
+bool isDecodedImageType(int type)
+{
+    return type == CV_32FC1 || type == CV_16UC1;
+}
+
+/// bit of camera in a set of cameras, the ones after the first 32 share the
+/// last bit (they might skip a few more points, but never produce duplicates)
+uint32_t cameraBit(size_t camera)
+{
+    return 1u << std::min<size_t>(camera, 31);
+}
+
+/// one index per row of rect, the matches of a pixel can be in any row
+std::vector<ZCodeRowIndex> buildRowIndexes(const cv::Mat &decodedImage, const cv::Rect &rect)
+{
+    std::vector<ZCodeRowIndex> indexes(size_t(rect.height));
+    const int bandCount = (rect.height + BAND_ROWS - 1) / BAND_ROWS;
+    ParallelUtils::forEachTile(bandCount, [&](int band) {
+        const int rowEnd = std::min(rect.height, (band + 1) * BAND_ROWS);
+        std::vector<float> buffer;
+        for (int row=band * BAND_ROWS; row<rowEnd; ++row) {
+            indexes[size_t(row)].build(ZDecodedPattern::codeRow(decodedImage, rect.y + row, rect.x, rect.width, buffer), rect.width);
+        }
+    });
+    return indexes;
+}
+
+} // anonymous namespace
+
+bool ZRayTriangulator::CameraRays::directionAt(float x, float y, cv::Vec3f *direction) const
+{
+    if (!(x >= 0.f && y >= 0.f && x <= float(directions.cols - 1) && y <= float(directions.rows - 1))) {
+        return false;
+    }
+
+    const int x0 = std::min(int(x), directions.cols - 2);
+    const int y0 = std::min(int(y), directions.rows - 2);
+    const float fx = x - float(x0);
+    const float fy = y - float(y0);
+    const cv::Vec3f *row0 = directions.ptr<cv::Vec3f>(y0) + x0;
+    const cv::Vec3f *row1 = directions.ptr<cv::Vec3f>(y0 + 1) + x0;
+
+    const cv::Vec3f interpolated = (1.f - fy) * ((1.f - fx) * row0[0] + fx * row0[1])
+            + fy * ((1.f - fx) * row1[0] + fx * row1[1]);
+
+    /// also false for pixels without a ray (NaN)
+    const float norm = float(cv::norm(interpolated));
+    if (!(norm > FLT_EPSILON)) {
+        return false;
+    }
+
+    *direction = interpolated / norm;
+    return true;
+}
+
+ZRayTriangulator::ZRayTriangulator(const std::vector<ZCameraCalibrationPtr> &calibrations)
+    : m_calibrations(calibrations)
+    , m_rays(calibrations.size())
+    , m_ready(false)
+{
+
+}
+
+bool ZRayTriangulator::ready() const
+{
+    return m_ready;
+}
+
+bool ZRayTriangulator::updateRays()
+{
+    m_ready = false;
+
+    for (size_t iCam=0; iCam<m_calibrations.size(); ++iCam) {
+        const ZCameraCalibrationPtr &calibration = m_calibrations[iCam];
+        if (!calibration || !calibration->ready()) {
+            qDebug() << "calibration of camera" << iCam << "is not ready";
+            return false;
+        }
+
+        if (calibration->cameraType() != ZCameraCalibration::CentralCameraType) {
+            qWarning() << "only central cameras are supported, camera" << iCam << "is not";
+            return false;
+        }
+
+        /// the calibration lookup table has the rays in the camera frame, the
+        /// pose is applied here so it's always the current one
+        const cv::Matx33f rotation = calibration->rotation();
+        CameraRays &rays = m_rays[iCam];
+        rays.origin = cv::Vec3f(calibration->translation());
+        rays.directions = cv::Mat(calibration->sensorHeight(), calibration->sensorWidth(), CV_32FC3);
+
+        const int rows = rays.directions.rows;
+        const int cols = rays.directions.cols;
+        const int bandCount = (rows + BAND_ROWS - 1) / BAND_ROWS;
+        ParallelUtils::forEachTile(bandCount, [&](int band) {
+            const cv::Vec3f nan(std::numeric_limits<float>::quiet_NaN(),
+                                std::numeric_limits<float>::quiet_NaN(),
+                                std::numeric_limits<float>::quiet_NaN());
+            cv::Vec3d origin;
+            cv::Vec3d direction;
+            const int rowEnd = std::min(rows, (band + 1) * BAND_ROWS);
+            for (int y=band * BAND_ROWS; y<rowEnd; ++y) {
+                cv::Vec3f *directions = rays.directions.ptr<cv::Vec3f>(y);
+                for (int x=0; x<cols; ++x) {
+                    directions[x] = calibration->getRayForPixel(x, y, origin, direction)
+                            ? rotation * cv::Vec3f(cv::normalize(direction))
+                            : nan;
+                }
+            }
+        });
+    }
+
+    m_ready = true;
+
+    return true;
+}
+
+size_t ZRayTriangulator::cameraCount() const
+{
+    return m_rays.size();
+}
+
+const ZRayTriangulator::CameraRays &ZRayTriangulator::rays(size_t camera) const
+{
+    return m_rays[camera];
+}
+
+ZPointCloudPtr ZRayTriangulator::triangulate(size_t camera, const cv::Mat &colorImage, const cv::Mat &decodedImage, const cv::Rect &roi,
+                                             size_t otherCamera, const cv::Mat &otherDecodedImage, const cv::Rect &otherRoi,
+                                             float maxSquaredDistance, bool organized) const
+{
+    if (!m_ready) {
+        qWarning() << "camera rays are not available";
+        return nullptr;
+    }
+
+    if (camera >= m_rays.size() || otherCamera >= m_rays.size() || camera == otherCamera) {
+        qWarning() << "invalid cameras" << camera << "and" << otherCamera;
+        return nullptr;
+    }
+
+    const CameraRays &rays = m_rays[camera];
+    const CameraRays &otherRays = m_rays[otherCamera];
+    const cv::Size imageSize = rays.directions.size();
+    if (decodedImage.size() != imageSize || otherDecodedImage.size() != otherRays.directions.size()) {
+        qWarning() << "decoded images don't have the calibrated size";
+        return nullptr;
+    }
+
+    if (!isDecodedImageType(decodedImage.type()) || !isDecodedImageType(otherDecodedImage.type())) {
+        qWarning() << "unkwnown image type:" << decodedImage.type() << otherDecodedImage.type();
+        return nullptr;
+    }
+
+    const cv::Rect rect = decodedRect(roi, imageSize);
+    const cv::Rect otherRect = decodedRect(otherRoi, otherDecodedImage.size());
+    if (rect.empty() || otherRect.empty()) {
+        qDebug() << "regions of interest are empty, nothing to triangulate";
+        return nullptr;
+    }
+
+    const bool hasColor = colorImage.type() == CV_8UC1 && colorImage.size() == imageSize;
+
+    const std::vector<ZCodeRowIndex> otherIndexes = buildRowIndexes(otherDecodedImage, otherRect);
+
+    const cv::Vec3f baseline = otherRays.origin - rays.origin;
+
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    ZSimplePointCloud::PointVector grid;
+    if (organized) {
+        grid.assign(size_t(imageSize.width) * size_t(imageSize.height), ZSimplePointCloud::PointType(nan, nan, nan, 0.f));
+    }
+
+    const int bandCount = (rect.height + BAND_ROWS - 1) / BAND_ROWS;
+    std::vector<ZSimplePointCloud::PointVector> bandPoints(size_t(bandCount));
+
+    ParallelUtils::forEachTile(bandCount, [&](int band) {
+        const int rowBegin = rect.y + band * BAND_ROWS;
+        const int rowEnd = std::min(rowBegin + BAND_ROWS, rect.y + rect.height);
+
+        RayPairBatch batch;
+        std::vector<float> codes(size_t(rect.width));
+        std::vector<float> buffer;
+
+        /// neighbour pixels have their match in neighbour rows, the search
+        /// starts from the previous match
+        int rowHint = -1;
+        for (int y=rowBegin; y<rowEnd; ++y) {
+            ZCodeRowIndex::subPixelCodes(ZDecodedPattern::codeRow(decodedImage, y, rect.x, rect.width, buffer), rect.width, codes.data());
+
+            const cv::Vec3f *directions = rays.directions.ptr<cv::Vec3f>(y);
+            const uint8_t *colorData = hasColor ? colorImage.ptr<uint8_t>(y) : nullptr;
+            int hint = rowHint >= 0 ? rowHint + 1 : y;
+            rowHint = -1;
+            int probes = 0;
+            for (int i=0; i<rect.width; ++i) {
+                const float code = codes[size_t(i)];
+                const int x = rect.x + i;
+                const cv::Vec3f &direction = directions[x];
+                if (std::isnan(code) || std::isnan(direction[0])) {
+                    continue;
+                }
+
+                const cv::Vec3f normal = baseline.cross(direction);
+                const bool probe = rowHint < 0 && probes < MAX_PROBES_PER_ROW;
+                probes += probe ? 1 : 0;
+
+                float otherX, otherY;
+                cv::Vec3f otherDirection;
+                if (!findEpipolarMatch(otherIndexes, otherRays, otherRect, code, normal, hint, probe, &otherX, &otherY)
+                        || !otherRays.directionAt(otherX, otherY, &otherDirection)) {
+                    continue;
+                }
+
+                /// a wrong match would move the search away from the
+                /// right row for the rest of the pixels
+                double distance;
+                GeometryUtils::intersectLineWithLine3D(rays.origin, direction, otherRays.origin, otherDirection, &distance);
+                if (!(distance <= maxSquaredDistance)) {
+                    continue;
+                }
+
+                hint = int(otherY);
+                if (rowHint < 0) {
+                    rowHint = hint;
+                }
+
+                batch.add(rays.origin, direction, otherRays.origin, otherDirection,
+                          size_t(y) * size_t(imageSize.width) + size_t(x),
+                          hasColor ? ZSimplePointCloud::grayToPackedColor(colorData[x]) : 0.f);
+            }
+        }
+
+        std::vector<cv::Vec4f> results;
+        batch.intersect(results);
+
+        auto &points = bandPoints[size_t(band)];
+        for (size_t i=0; i<results.size(); ++i) {
+            const cv::Vec4f &result = results[i];
+            /// also discards NaN, i.e. parallel rays
+            if (!(result[3] <= maxSquaredDistance)) {
+                continue;
+            }
+
+            const ZSimplePointCloud::PointType point(result[0], result[1], result[2], batch.colors[i]);
+            if (organized) {
+                grid[batch.pixels[i]] = point;
+            } else {
+                points.push_back(point);
+            }
+        }
+    });
+
+    if (organized) {
+        auto cloud = new ZSimplePointCloud(std::move(grid), unsigned(imageSize.width), unsigned(imageSize.height));
+        qDebug() << "found" << cloud->validPointCount() << "valid matches";
+        if (cloud->validPointCount() < 1) {
+            delete cloud;
+            return nullptr;
+        }
+        return ZPointCloudPtr(cloud);
+    }
+
+    size_t pointCount = 0;
+    for (const auto &points : bandPoints) {
+        pointCount += points.size();
+    }
+
+    qDebug() << "found" << pointCount << "valid matches";
+
+    if (pointCount < 1) {
+        return nullptr;
+    }
+
+    ZSimplePointCloud::PointVector points;
+    points.reserve(pointCount);
+    for (auto &band : bandPoints) {
+        points.insert(points.end(), band.cbegin(), band.cend());
+        ZSimplePointCloud::PointVector().swap(band);
+    }
+
+    return ZPointCloudPtr(new ZSimplePointCloud(std::move(points)));
+}
+
+ZPointCloudPtr ZRayTriangulator::triangulate(const std::vector<cv::Mat> &colorImages,
+                                             const std::vector<cv::Mat> &decodedImages,
+                                             const std::vector<cv::Rect> &rois,
+                                             float maxSquaredDistance,
+                                             size_t minViews) const
+{
+    if (!m_ready) {
+        qWarning() << "camera rays are not available";
+        return nullptr;
+    }
+
+    const size_t cameraCount = m_rays.size();
+    if (decodedImages.size() != cameraCount || colorImages.size() != cameraCount || rois.size() != cameraCount) {
+        qWarning() << "expected images of" << cameraCount << "cameras, got" << decodedImages.size();
+        return nullptr;
+    }
+
+    std::vector<cv::Rect> rects(cameraCount);
+    std::vector<int> imageRows(cameraCount);
+    for (size_t iCam=0; iCam<cameraCount; ++iCam) {
+        const cv::Mat &decodedImage = decodedImages[iCam];
+        if (decodedImage.size() != m_rays[iCam].directions.size()) {
+            qWarning() << "decoded image of camera" << iCam << "doesn't have the calibrated size";
+            return nullptr;
+        }
+        if (!isDecodedImageType(decodedImage.type())) {
+            qWarning() << "unkwnown image type:" << decodedImage.type();
+            return nullptr;
+        }
+        rects[iCam] = decodedRect(rois[iCam], decodedImage.size());
+        imageRows[iCam] = rects[iCam].height;
+    }
+
+    std::vector<std::vector<ZCodeRowIndex> > indexes(cameraCount);
+    for (size_t iCam=0; iCam<cameraCount; ++iCam) {
+        indexes[iCam] = buildRowIndexes(decodedImages[iCam], rects[iCam]);
+    }
+
+    /// every band has its own buffer
+    std::vector<std::vector<ZSimplePointCloud::PointVector> > bandPoints(cameraCount);
+    for (size_t iCam=0; iCam<cameraCount; ++iCam) {
+        bandPoints[iCam].resize(size_t((imageRows[iCam] + BAND_ROWS - 1) / BAND_ROWS));
+    }
+
+    /// cameras used by the point computed from each pixel (one bit per
+    /// camera, 0 if there's no point), so a later camera only skips the
+    /// points that were really computed before with its view
+    std::vector<cv::Mat> pointViews(cameraCount);
+    for (size_t iCam=0; iCam<cameraCount; ++iCam) {
+        pointViews[iCam] = cv::Mat(decodedImages[iCam].size(), CV_32SC1, cv::Scalar(0));
+    }
+
+    /// cameras are processed in order (their bands in parallel), so the views
+    /// of the previous cameras are complete
+    for (size_t iCam=0; iCam<cameraCount; ++iCam) {
+        ParallelUtils::forEachRowBand({ imageRows[iCam] }, [&](int, int bandBegin, int bandEnd) {
+            const CameraRays &rays = m_rays[iCam];
+            const cv::Rect &rect = rects[iCam];
+            const cv::Mat &colorImage = colorImages[iCam];
+            const bool hasColor = colorImage.type() == CV_8UC1 && colorImage.size() == decodedImages[iCam].size();
+            auto &points = bandPoints[iCam][size_t(bandBegin / BAND_ROWS)];
+
+            std::vector<float> codes(size_t(rect.width));
+            std::vector<float> buffer;
+            std::vector<cv::Vec3f> origins;
+            std::vector<cv::Vec3f> directions;
+            cv::Mat &views = pointViews[iCam];
+            origins.reserve(cameraCount);
+            directions.reserve(cameraCount);
+
+            /// where the search starts in every other camera
+            std::vector<int> hints(cameraCount);
+            std::vector<int> rowHints(cameraCount, -1);
+            std::vector<int> probes(cameraCount);
+
+            for (int y=rect.y + bandBegin; y<rect.y + bandEnd; ++y) {
+                ZCodeRowIndex::subPixelCodes(ZDecodedPattern::codeRow(decodedImages[iCam], y, rect.x, rect.width, buffer), rect.width, codes.data());
+
+                const cv::Vec3f *rowDirections = rays.directions.ptr<cv::Vec3f>(y);
+                const uint8_t *colorData = hasColor ? colorImage.ptr<uint8_t>(y) : nullptr;
+                int32_t *viewsData = views.ptr<int32_t>(y);
+                for (size_t jCam=0; jCam<cameraCount; ++jCam) {
+                    hints[jCam] = rowHints[jCam] >= 0 ? rowHints[jCam] + 1 : y;
+                    rowHints[jCam] = -1;
+                    probes[jCam] = 0;
+                }
+
+                for (int i=0; i<rect.width; ++i) {
+                    const float code = codes[size_t(i)];
+                    const int x = rect.x + i;
+                    const cv::Vec3f &direction = rowDirections[x];
+                    if (std::isnan(code) || std::isnan(direction[0])) {
+                        continue;
+                    }
+
+                    origins.assign(1, rays.origin);
+                    directions.assign(1, direction);
+                    uint32_t pointCameras = cameraBit(iCam);
+
+                    /// skip the points a previous camera already computed using
+                    /// this one (it could have discarded them, or not found this
+                    /// match, the search is not symmetric)
+                    bool seenBefore = false;
+                    for (size_t jCam=0; jCam<cameraCount && !seenBefore; ++jCam) {
+                        if (jCam == iCam) {
+                            continue;
+                        }
+
+                        const CameraRays &otherRays = m_rays[jCam];
+                        const cv::Vec3f normal = (otherRays.origin - rays.origin).cross(direction);
+                        const bool probe = rowHints[jCam] < 0 && probes[jCam] < MAX_PROBES_PER_ROW;
+                        probes[jCam] += probe ? 1 : 0;
+
+                        float otherX, otherY;
+                        cv::Vec3f otherDirection;
+                        if (!findEpipolarMatch(indexes[jCam], otherRays, rects[jCam], code, normal, hints[jCam], probe, &otherX, &otherY)
+                                || !otherRays.directionAt(otherX, otherY, &otherDirection)) {
+                            continue;
+                        }
+
+                        /// discard wrong matches before they spoil the others
+                        double distance;
+                        GeometryUtils::intersectLineWithLine3D(rays.origin, direction, otherRays.origin, otherDirection, &distance);
+                        if (!(distance <= maxSquaredDistance)) {
+                            continue;
+                        }
+
+                        hints[jCam] = int(otherY);
+                        if (rowHints[jCam] < 0) {
+                            rowHints[jCam] = hints[jCam];
+                        }
+
+                        if (jCam < iCam) {
+                            const int32_t otherViews = pointViews[jCam].at<int32_t>(cvRound(otherY), cvRound(otherX));
+                            seenBefore = (uint32_t(otherViews) & cameraBit(iCam)) != 0;
+                        }
+                        pointCameras |= cameraBit(jCam);
+                        origins.push_back(otherRays.origin);
+                        directions.push_back(otherDirection);
+                    }
+
+                    if (seenBefore || origins.size() < std::max<size_t>(minViews, 2)) {
+                        continue;
+                    }
+
+                    double distance;
+                    const cv::Vec3d point = GeometryUtils::intersectLines3D(origins.data(), directions.data(), origins.size(), &distance);
+                    if (!(distance <= maxSquaredDistance)) {
+                        continue;
+                    }
+
+                    points.push_back(ZSimplePointCloud::PointType(float(point[0]), float(point[1]), float(point[2]),
+                                                                  hasColor ? ZSimplePointCloud::grayToPackedColor(colorData[x]) : 0.f));
+                    viewsData[x] = int32_t(pointCameras);
+                }
+            }
+        }, 0, BAND_ROWS);
+    }
+
+    size_t pointCount = 0;
+    for (const auto &cameraPoints : bandPoints) {
+        for (const auto &points : cameraPoints) {
+            pointCount += points.size();
+        }
+    }
+
+    qDebug() << "found" << pointCount << "valid points in" << cameraCount << "cameras";
+
+    if (pointCount < 1) {
+        return nullptr;
+    }
+
+    ZSimplePointCloud::PointVector points;
+    points.reserve(pointCount);
+    for (auto &cameraPoints : bandPoints) {
+        for (auto &band : cameraPoints) {
+            points.insert(points.end(), band.cbegin(), band.cend());
+            ZSimplePointCloud::PointVector().swap(band);
+        }
+    }
+
+    return ZPointCloudPtr(new ZSimplePointCloud(std::move(points)));
+}
+
+} // namespace Z3D
@@ -0,0 +1,105 @@
+/* * Z3D - A structured light 3D scanner
+ * Copyright (C) 2013-2016 Nicolas Ulrich <nikolaseu@gmail.com>
+ *
+ * This file is part of Z3D.
+ *
+ * Z3D is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Z3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Z3D.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+#pragma once
+
+#include "zstructuredlight_global.h"
+
+#include "zcameracalibration_fwd.h"
+#include "zpointcloud_fwd.h"
+
+#include <opencv2/core/mat.hpp>
+
+#include <vector>
+
+namespace Z3D
+{
+
+/// Triangulates decoded images by intersecting the rays of corresponding
+/// pixels, without rectification (so there's no resampling of the decoded
+/// images and it works with any camera model in the calibrations).
+/// The world ray of every pixel is computed once from the calibration lookup
+/// tables. Correspondences are searched along the epipolar curve, i.e. for a
+/// pixel of one camera, the pixel of the other camera with the same code whose
+/// ray is coplanar with it and the baseline
+class Z3D_STRUCTUREDLIGHT_SHARED_EXPORT ZRayTriangulator
+{
+public:
+    /// world rays of every pixel of a (central) camera
+    struct CameraRays
+    {
+        cv::Vec3f origin;
+        /// CV_32FC3, unit direction of each pixel
+        cv::Mat directions;
+
+        bool empty() const { return directions.empty(); }
+
+        /// direction for a sub-pixel position, false if it's outside the image
+        bool directionAt(float x, float y, cv::Vec3f *direction) const;
+    };
+
+    explicit ZRayTriangulator(const std::vector<ZCameraCalibrationPtr> &calibrations);
+
+    /// true if the rays of every camera are available
+    bool ready() const;
+
+    /// builds the rays of every camera, false if some calibration is not
+    /// ready yet or it's not a central camera
+    bool updateRays();
+
+    size_t cameraCount() const;
+    const CameraRays &rays(size_t camera) const;
+
+    /// finds the correspondence of every decoded pixel of camera in otherCamera
+    /// and intersects their rays. Intersections where the rays are more than
+    /// sqrt(maxSquaredDistance) away from each other are discarded.
+    /// roi and otherRoi are the decoded regions of each image, empty to use
+    /// the whole image. Organized clouds have one point per pixel of camera
+    ZPointCloudPtr triangulate(size_t camera,
+                               const cv::Mat &colorImage,
+                               const cv::Mat &decodedImage,
+                               const cv::Rect &roi,
+                               size_t otherCamera,
+                               const cv::Mat &otherDecodedImage,
+                               const cv::Rect &otherRoi,
+                               float maxSquaredDistance,
+                               bool organized) const;
+
+    /// finds the correspondences of every decoded pixel in all the other
+    /// cameras and computes the point closest to all their rays (least
+    /// squares). Points seen by at least minViews cameras are kept. A camera
+    /// doesn't compute the points a previous camera already computed with
+    /// its view, so there are no duplicates. Matches (and points) farther than
+    /// sqrt(maxSquaredDistance) from a ray are discarded.
+    /// There's one image/roi per camera, color images can be empty
+    ZPointCloudPtr triangulate(const std::vector<cv::Mat> &colorImages,
+                               const std::vector<cv::Mat> &decodedImages,
+                               const std::vector<cv::Rect> &rois,
+                               float maxSquaredDistance,
+                               size_t minViews = 2) const;
+
+private:
+    std::vector<ZCameraCalibrationPtr> m_calibrations;
+    std::vector<CameraRays> m_rays;
+    bool m_ready;
+};
+
+} // namespace Z3D
@@ -0,0 +1,101 @@
+/* * Z3D - A structured light 3D scanner
+ * Copyright (C) 2013-2016 Nicolas Ulrich <nikolaseu@gmail.com>
+ *
+ * This file is part of Z3D.
+ *
+ * Z3D is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Z3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Z3D.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <opencv2/core/utility.hpp> // checkHardwareSupport
+
+/// x86 SIMD kernels are compiled with per-function target attributes, so the
+/// rest of the code does not need special compiler flags. The best supported
+/// instruction set is selected at runtime, see SimdUtils::bestSupportedLevel
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#  define Z3D_SIMD_X86
+#  include <immintrin.h>
+#  if defined(_MSC_VER) && !defined(__clang__)
+/// MSVC allows to use any intrinsic without enabling it first
+#    define Z3D_TARGET_SSE41
+#    define Z3D_TARGET_AVX2
+#    define Z3D_TARGET_AVX2_FMA
+#  else
+#    define Z3D_TARGET_SSE41    __attribute__((target("sse4.1")))
+#    define Z3D_TARGET_AVX2     __attribute__((target("avx2")))
+#    define Z3D_TARGET_AVX2_FMA __attribute__((target("avx2,fma")))
+#  endif
+#endif
+
+namespace Z3D
+{
+
+namespace SimdUtils
+{
+
+enum SimdLevel {
+    SimdScalar = 0,
+    SimdSSE41,
+    SimdAVX2
+};
+
+/**
+ * @brief SimdUtils::bestSupportedLevel
+ * Returns the best instruction set supported by the CPU we are running on.
+ * Scalar code is always available as a fallback (i.e. ARM, old CPUs).
+ */
+inline SimdLevel bestSupportedLevel()
+{
+#if defined(Z3D_SIMD_X86)
+    if (cv::checkHardwareSupport(CV_CPU_AVX2)) {
+        return SimdAVX2;
+    }
+    if (cv::checkHardwareSupport(CV_CPU_SSE4_1)) {
+        return SimdSSE41;
+    }
+#endif
+    return SimdScalar;
+}
+
+/**
+ * @brief SimdUtils::hasFma
+ * Fused multiply-add is a separate extension, kernels using it must also check
+ * this (almost every CPU with AVX2 has it)
+ */
+inline bool hasFma()
+{
+#if defined(Z3D_SIMD_X86)
+    return cv::checkHardwareSupport(CV_CPU_FMA3);
+#else
+    return false;
+#endif
+}
+
+inline const char *levelName(SimdLevel level)
+{
+    switch (level) {
+    case SimdAVX2:
+        return "AVX2";
+    case SimdSSE41:
+        return "SSE4.1";
+    case SimdScalar:
+        break;
+    }
+    return "scalar";
+}
+
+} // namespace SimdUtils
+
+} // namespace Z3D
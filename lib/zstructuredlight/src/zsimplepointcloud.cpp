@@ -22,37 +22,35 @@
 
 #include <zpointfield.h>
 
+#include <QDebug>
+
+#include <cmath>
+
 namespace Z3D
 {
 
-ZSimplePointCloud::ZSimplePointCloud(const ZSimplePointCloud::PointVector points, QObject *parent)
+ZSimplePointCloud::ZSimplePointCloud(ZSimplePointCloud::PointVector points, QObject *parent)
     : ZPointCloud(parent)
-    , m_fields({
-               new ZPointField("x",    0, ZPointField::FLOAT32, 1, this),
-               new ZPointField("y",    4, ZPointField::FLOAT32, 1, this),
-               new ZPointField("z",    8, ZPointField::FLOAT32, 1, this),
-               new ZPointField("rgb", 12, ZPointField::FLOAT32, 1, this)
-    })
+    , m_fields(createFields(this))
     , m_points(std::move(points))
-    , m_width(m_points.size())
+    , m_width(unsigned(m_points.size()))
     , m_height(1)
 {
-    PointType min = points.front()
-            , max = points.front();
+    init();
+}
 
-    for (const auto &point : points) {
-        for (int i=0; i<3; ++i) {
-            if (point[i] > max[i]) {
-                max[i] = point[i];
-            }
-            if (point[i] < min[i]) {
-                min[i] = point[i];
-            }
-        }
+ZSimplePointCloud::ZSimplePointCloud(ZSimplePointCloud::PointVector points, unsigned int width, unsigned int height, QObject *parent)
+    : ZPointCloud(parent)
+    , m_fields(createFields(this))
+    , m_points(std::move(points))
+    , m_width(width)
+    , m_height(height)
+{
+    if (size_t(m_width) * size_t(m_height) != m_points.size()) {
+        qWarning() << "invalid organized point cloud size" << m_width << "x" << m_height << "for" << m_points.size() << "points";
     }
 
-    m_minimum = QVector3D(min[0], min[1], min[2]);
-    m_maximum = QVector3D(max[0], max[1], max[2]);
+    init();
 }
 
 ZSimplePointCloud::~ZSimplePointCloud()
@@ -82,7 +80,8 @@ unsigned int ZSimplePointCloud::pointStep() const
 
 unsigned int ZSimplePointCloud::rowStep() const
 {
-    return width();
+    /// size of a row in bytes
+    return width() * pointStep();
 }
 
 QByteArray ZSimplePointCloud::data() const
@@ -111,4 +110,76 @@ QVector3D ZSimplePointCloud::center() const
     return (m_minimum + m_maximum) / 2.;
 }
 
+bool ZSimplePointCloud::isOrganized() const
+{
+    return m_height > 1;
+}
+
+bool ZSimplePointCloud::isValid(size_t index) const
+{
+    return m_validity[index / 8] & (1 << (index % 8));
+}
+
+bool ZSimplePointCloud::isValid(unsigned int x, unsigned int y) const
+{
+    return isValid(size_t(y) * m_width + x);
+}
+
+const std::vector<uint8_t> &ZSimplePointCloud::validityBitmap() const
+{
+    return m_validity;
+}
+
+size_t ZSimplePointCloud::validPointCount() const
+{
+    return m_validPointCount;
+}
+
+std::vector<ZPointField *> ZSimplePointCloud::createFields(QObject *parent)
+{
+    return {
+        new ZPointField("x",    0, ZPointField::FLOAT32, 1, parent),
+        new ZPointField("y",    4, ZPointField::FLOAT32, 1, parent),
+        new ZPointField("z",    8, ZPointField::FLOAT32, 1, parent),
+        new ZPointField("rgb", 12, ZPointField::FLOAT32, 1, parent)
+    };
+}
+
+void ZSimplePointCloud::init()
+{
+    /// one bit per point, set if the point is valid (not NaN/inf)
+    m_validity.assign((m_points.size() + 7) / 8, 0);
+    m_validPointCount = 0;
+
+    PointType min(0, 0, 0, 0)
+            , max(0, 0, 0, 0);
+
+    for (size_t index=0; index<m_points.size(); ++index) {
+        const auto &point = m_points[index];
+        if (!std::isfinite(point[0]) || !std::isfinite(point[1]) || !std::isfinite(point[2])) {
+            continue;
+        }
+
+        m_validity[index / 8] |= uint8_t(1 << (index % 8));
+
+        if (!m_validPointCount++) {
+            min = point;
+            max = point;
+            continue;
+        }
+
+        for (int i=0; i<3; ++i) {
+            if (point[i] > max[i]) {
+                max[i] = point[i];
+            }
+            if (point[i] < min[i]) {
+                min[i] = point[i];
+            }
+        }
+    }
+
+    m_minimum = QVector3D(min[0], min[1], min[2]);
+    m_maximum = QVector3D(max[0], max[1], max[2]);
+}
+
 } // namespace Z3D
@@ -25,6 +25,8 @@
 
 #include <opencv2/core/matx.hpp>
 
+#include <cstring> // memcpy
+
 namespace Z3D
 {
 
@@ -36,7 +38,9 @@ public:
     typedef cv::Vec4f PointType;
     typedef std::vector<PointType> PointVector;
 
-    explicit ZSimplePointCloud(const PointVector points, QObject *parent = nullptr);
+    explicit ZSimplePointCloud(PointVector points, QObject *parent = nullptr);
+    /// organized cloud, points are stored by rows and invalid points are NaN
+    explicit ZSimplePointCloud(PointVector points, unsigned int width, unsigned int height, QObject *parent = nullptr);
     ~ZSimplePointCloud() override;
 
     // ZPointCloud interface
@@ -51,6 +55,31 @@ public:
     virtual QVector3D maximum() const override;
     virtual QVector3D center() const override;
 
+    bool isOrganized() const;
+
+    /// gray value as rgb, packed in a float (that's how the cloud stores colors)
+    static inline float grayToPackedColor(uint8_t gray)
+    {
+        const uint32_t rgbWhite = (static_cast<uint32_t>(gray) << 24 | // alpha
+                                   static_cast<uint32_t>(gray) << 16 | // r
+                                   static_cast<uint32_t>(gray) <<  8 | // g
+                                   static_cast<uint32_t>(gray));       // b
+        float packed;
+        memcpy(&packed, &rgbWhite, sizeof(packed));
+        return packed;
+    }
+
+    /// validity of each point, mostly useful for organized clouds
+    bool isValid(size_t index) const;
+    bool isValid(unsigned int x, unsigned int y) const;
+    /// one bit per point (bit i % 8 of byte i / 8), set if the point is valid
+    const std::vector<uint8_t> &validityBitmap() const;
+    size_t validPointCount() const;
+
+private:
+    static std::vector<ZPointField *> createFields(QObject *parent);
+    void init();
+
 public:
     const std::vector<ZPointField*> m_fields;
 
@@ -59,6 +88,9 @@ public:
     const unsigned int m_width;
     const unsigned int m_height;
 
+    std::vector<uint8_t> m_validity;
+    size_t m_validPointCount;
+
     QVector3D m_minimum;
     QVector3D m_maximum;
 };
@@ -24,15 +24,11 @@ namespace Z3D
 {
 
 ZStructuredLightPattern::ZStructuredLightPattern(cv::Mat decodedImage,
-                                                 std::map<int, std::vector<cv::Vec2f> > fringePointsList)
+                                                 ZFringePoints fringePoints)
     : m_decodedImage(decodedImage)
-    , m_estimatedCloudPoints(0)
+    , m_fringePoints(std::move(fringePoints))
 {
-    m_fringePointsList = std::move(fringePointsList);
 
-    for (auto it = fringePointsList.cbegin(), itEnd = fringePointsList.cend(); it != itEnd; ++it) {
-        m_estimatedCloudPoints += it->second.size();
-    }
 }
 
 cv::Mat ZStructuredLightPattern::decodedImage() const
@@ -40,14 +36,14 @@ cv::Mat ZStructuredLightPattern::decodedImage() const
     return m_decodedImage;
 }
 
-std::map<int, std::vector<cv::Vec2f> > ZStructuredLightPattern::fringePointsList() const
+const ZFringePoints &ZStructuredLightPattern::fringePoints() const
 {
-    return m_fringePointsList;
+    return m_fringePoints;
 }
 
 int ZStructuredLightPattern::estimatedCloudPoints() const
 {
-    return m_estimatedCloudPoints;
+    return int(m_fringePoints.pointCount());
 }
 
 } // namespace Z3D
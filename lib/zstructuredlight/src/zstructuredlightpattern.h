@@ -21,9 +21,9 @@
 
 #include "zstructuredlight_global.h"
 
-#include <opencv2/core/mat.hpp>
+#include "zfringepoints.h"
 
-#include <map>
+#include <opencv2/core/mat.hpp>
 
 namespace Z3D
 {
@@ -32,16 +32,15 @@ struct Z3D_STRUCTUREDLIGHT_SHARED_EXPORT ZStructuredLightPattern
 {
 public:
     explicit ZStructuredLightPattern(cv::Mat decodedImage,
-                                     std::map<int, std::vector<cv::Vec2f> > fringePointsList);
+                                     ZFringePoints fringePoints);
 
     cv::Mat decodedImage() const;
-    std::map<int, std::vector<cv::Vec2f> > fringePointsList() const;
+    const ZFringePoints &fringePoints() const;
     int estimatedCloudPoints() const;
 
 private:
     cv::Mat m_decodedImage;
-    std::map<int, std::vector<cv::Vec2f> > m_fringePointsList;
-    int m_estimatedCloudPoints;
+    ZFringePoints m_fringePoints;
 };
 
 } // namespace Z3D
@@ -50,6 +50,8 @@ ZStructuredLightSystem::ZStructuredLightSystem(
     connect(m_patternProjection.get(), &ZPatternProjection::finishAcquisition,
             m_acqManager.get(), &ZCameraAcquisitionManager::finishAcquisition);
 
+    connect(m_acqManager.get(), &ZCameraAcquisitionManager::imagesAcquired,
+            m_patternProjection.get(), &ZPatternProjection::onImagesAcquired);
     connect(m_acqManager.get(), &ZCameraAcquisitionManager::acquisitionFinished,
             m_patternProjection.get(), &ZPatternProjection::processImages);
 
@@ -110,6 +112,58 @@ bool ZStructuredLightSystem::setDebugShowDecodedImages(bool debugShowDecodedImag
     return true;
 }
 
+QRect ZStructuredLightSystem::roi() const
+{
+    const cv::Rect roi = m_patternProjection->roi();
+    return QRect(roi.x, roi.y, roi.width, roi.height);
+}
+
+bool ZStructuredLightSystem::setRoi(QRect roi)
+{
+    if (this->roi() == roi) {
+        return true;
+    }
+
+    m_patternProjection->setRoi(cv::Rect(roi.x(), roi.y(), roi.width(), roi.height()));
+    emit roiChanged(roi);
+
+    return true;
+}
+
+bool ZStructuredLightSystem::autoRoi() const
+{
+    return m_patternProjection->autoRoi();
+}
+
+bool ZStructuredLightSystem::setAutoRoi(bool autoRoi)
+{
+    if (m_patternProjection->autoRoi() == autoRoi) {
+        return true;
+    }
+
+    m_patternProjection->setAutoRoi(autoRoi);
+    emit autoRoiChanged(autoRoi);
+
+    return true;
+}
+
+bool ZStructuredLightSystem::floatDecodedImages() const
+{
+    return m_patternProjection->floatDecodedImages();
+}
+
+bool ZStructuredLightSystem::setFloatDecodedImages(bool floatDecodedImages)
+{
+    if (m_patternProjection->floatDecodedImages() == floatDecodedImages) {
+        return true;
+    }
+
+    m_patternProjection->setFloatDecodedImages(floatDecodedImages);
+    emit floatDecodedImagesChanged(floatDecodedImages);
+
+    return true;
+}
+
 void ZStructuredLightSystem::onPatternsDecodedDebug(std::vector<ZDecodedPatternPtr> patterns)
 {
     if (!m_debugShowDecodedImages) {
@@ -121,9 +175,17 @@ void ZStructuredLightSystem::onPatternsDecodedDebug(std::vector<ZDecodedPatternP
            absMinVal = DBL_MAX,
            absMaxVal = DBL_MIN;
 
-    /// only to show in the window, we need to change image "range" to improve visibility
+    /// codes in floating point, whatever the decoded image type is
+    std::vector<cv::Mat> decodedImages;
     for (const auto &decodedPattern : patterns) {
-        cv::Mat decoded = decodedPattern->decodedImage().clone();
+        cv::Mat decoded;
+        Z3D::ZDecodedPattern::convertDecodedImage(decodedPattern->decodedImage(), decoded, CV_32FC1);
+        decodedImages.push_back(decoded);
+    }
+
+    /// only to show in the window, we need to change image "range" to improve visibility
+    for (const auto &decodedImage : decodedImages) {
+        cv::Mat decoded = decodedImage.clone();
 
         /// find minimum and maximum intensities
         cv::minMaxLoc(decoded, &minVal, &maxVal);
@@ -155,9 +217,7 @@ void ZStructuredLightSystem::onPatternsDecodedDebug(std::vector<ZDecodedPatternP
              << "range:" << range;
 
     int iCam = 0;
-    for (const auto &decodedPattern : patterns) {
-        cv::Mat decodedImage = decodedPattern->decodedImage();
-
+    for (const auto &decodedImage : decodedImages) {
         /// convert to "visible" image to show in window
         cv::Mat decodedVisibleImage;
         decodedImage.convertTo(decodedVisibleImage, CV_8U, 255.0/range, -absMinVal * 255.0/range);
@@ -26,6 +26,7 @@
 #include "zpointcloud_fwd.h"
 
 #include <QObject>
+#include <QRect>
 
 class QSettings;
 
@@ -38,6 +39,9 @@ class Z3D_STRUCTUREDLIGHT_SHARED_EXPORT ZStructuredLightSystem : public QObject
 
     Q_PROPERTY(bool ready READ ready WRITE setReady NOTIFY readyChanged)
     Q_PROPERTY(bool debugShowDecodedImages READ debugShowDecodedImages WRITE setDebugShowDecodedImages NOTIFY debugShowDecodedImagesChanged)
+    Q_PROPERTY(QRect roi READ roi WRITE setRoi NOTIFY roiChanged)
+    Q_PROPERTY(bool autoRoi READ autoRoi WRITE setAutoRoi NOTIFY autoRoiChanged)
+    Q_PROPERTY(bool floatDecodedImages READ floatDecodedImages WRITE setFloatDecodedImages NOTIFY floatDecodedImagesChanged)
 
 public:
     explicit ZStructuredLightSystem(ZCameraAcquisitionManagerPtr acquisitionManager,
@@ -51,11 +55,23 @@ public:
     bool ready() const;
     bool debugShowDecodedImages() const;
 
+    /// region of the camera images to scan, empty to use the whole image.
+    /// Decoding and triangulation only process this region
+    QRect roi() const;
+    /// reduce the region to scan to the pixels lit by the projector
+    bool autoRoi() const;
+    /// decode to floating point images instead of fixed point ones (more
+    /// precision for sub-fringe codes, twice the memory)
+    bool floatDecodedImages() const;
+
     ZPatternProjectionPtr patternProjection() const;
 
 signals:
     void readyChanged(bool ready);
     void debugShowDecodedImagesChanged(bool debugShowDecodedImages);
+    void roiChanged(QRect roi);
+    void autoRoiChanged(bool autoRoi);
+    void floatDecodedImagesChanged(bool floatDecodedImages);
 
     void scanFinished(Z3D::ZPointCloudPtr cloud);
 
@@ -64,6 +80,9 @@ public slots:
 
     void setReady(bool ready);
     bool setDebugShowDecodedImages(bool debugShowDecodedImages);
+    bool setRoi(QRect roi);
+    bool setAutoRoi(bool autoRoi);
+    bool setFloatDecodedImages(bool floatDecodedImages);
 
 protected slots:
     virtual void onPatternProjected(Z3D::ZProjectedPatternPtr pattern) = 0;